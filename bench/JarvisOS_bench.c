@@ -0,0 +1,530 @@
+/******************************************************************************
+ * [File Name]:     JarvisOS_bench.c
+ *
+ * [Description]:   Kernel Benchmark Application. Replaces the user application
+ *                  (it has its own main) and measures, in CPU cycles:
+ *                  - LoadNextThread and a PendSV context switch
+ *                  - The ready bitmap selection against the linear scan it
+ *                    replaced, for several thread counts
+ *                  - SysTick_Handler, with 0..N suspended threads
+ *                  - Thread_Suspend to resume latency
+ *                  - Thread_Yield switch between two threads
+ *                  - Semaphore ping-pong round trips
+ *                  - Queue throughput for several queue lengths
+ *                  Results are printed through ARM semihosting, one CSV line
+ *                  per measurement:
+ *                  JARVIS_BENCH,<name>,<param>,<samples>,<min>,<avg>,<max>
+ *                  Not built or run yet: see the README's Benchmarks section.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "JarvisOS_bench.h"
+#include "semaphore.h"
+#include "queue.h"
+
+#define BENCH_SYNC()            __asm(" DSB"); __asm(" ISB")
+
+/* Helper threads available next to the benchmark thread */
+#define BENCH_HELPERS           (NUM_OF_THREADS - 1)
+
+#if (BENCH_HELPERS < 1)
+#error "Jarvis-OS Bench: NUM_OF_THREADS must be at least 2"
+#endif
+
+/* Queue lengths measured by benchQueue */
+static const uint32_t g_QueueLengths[] = {1, 4, 16, 64};
+
+/* Thread counts measured by benchScan */
+static const uint8_t g_ScanCounts[] = {2, 4, 8, 16, 32};
+
+
+/*******************************************************************************
+ *                          Global Variables
+ ******************************************************************************/
+static int32_t g_BenchStack[BENCH_STACK_SIZE];
+static int32_t g_HelperStacks[BENCH_HELPERS][BENCH_HELPER_STACK];
+
+static SemaphoreHandle_t g_Ping;
+static SemaphoreHandle_t g_Pong;
+
+static xQUEUE g_QueueBuffer;
+static uint32_t g_QueueStorage[QUEUE_STORAGE_WORDS(64, sizeof(uint32_t))];
+static QueueHandle_t g_Queue;
+
+static TCB g_ScanThreads[BENCH_SCAN_MAX];
+static TCB * volatile g_Selected;                           /* Keeps the selections from being optimized out */
+
+static Bench_Stats g_Stats;
+static volatile uint32_t g_YieldStamp;
+static volatile uint8_t g_YieldRunning;
+
+static char g_Line[96];
+
+
+/*******************************************************************************
+ *                          Cycle Counter
+ ******************************************************************************/
+/******************************************************************************
+ *
+ * [Function Name]:     benchInitCycles
+ *
+ * [Description]:       Starts the DWT cycle counter. Without it (BENCH_USE_DWT 0,
+ *                      e.g. under QEMU) the SysTick down counter, clocked by the
+ *                      CPU, is used instead.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+static void benchInitCycles (void)
+{
+#if (BENCH_USE_DWT == 1)
+    ACCESS_REG(DEMCR,0) |= DEMCR_TRCENA;
+    ACCESS_REG(DWT,DWT_CYCCNT) = 0;
+    ACCESS_REG(DWT,DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+static uint32_t benchNow (void)
+{
+#if (BENCH_USE_DWT == 1)
+    return ACCESS_REG(DWT,DWT_CYCCNT);
+#else
+    return ACCESS_REG(SysTick,STCURRENT);
+#endif
+}
+
+/* Cycles from start to end. The SysTick counter counts down and may have
+ * reloaded once in between */
+static uint32_t benchElapsed (uint32_t start, uint32_t end)
+{
+#if (BENCH_USE_DWT == 1)
+    return end - start;
+#else
+    if (start >= end)
+        return start - end;
+    return start + ACCESS_REG(SysTick,STRELOAD) + 1 - end;
+#endif
+}
+
+
+/*******************************************************************************
+ *                          Results
+ ******************************************************************************/
+static void statsReset (Bench_Stats *stats)
+{
+    stats->count = 0;
+    stats->min = 0xFFFFFFFF;
+    stats->max = 0;
+    stats->sum = 0;
+}
+
+static void statsAdd (Bench_Stats *stats, uint32_t cycles)
+{
+    stats->count++;
+    stats->sum += cycles;
+    if (cycles < stats->min)
+        stats->min = cycles;
+    if (cycles > stats->max)
+        stats->max = cycles;
+}
+
+/* Appends a decimal number to g_Line at position pos, returns the new position */
+static uint32_t lineNumber (uint32_t pos, uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0)
+        g_Line[pos++] = digits[--count];
+
+    return pos;
+}
+
+/* Appends a string to g_Line at position pos, returns the new position */
+static uint32_t lineString (uint32_t pos, const char *text)
+{
+    while (*text)
+        g_Line[pos++] = *text++;
+
+    return pos;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     benchReport
+ *
+ * [Description]:       Prints one result line:
+ *                      JARVIS_BENCH,<name>,<param>,<samples>,<min>,<avg>,<max>
+ *
+ * [Arguments]:         const char *name, uint32_t param, Bench_Stats *stats
+ * [Return]:            void
+ *
+ *****************************************************************************/
+static void benchReport (const char *name, uint32_t param, Bench_Stats *stats)
+{
+    uint32_t pos;
+
+    if (stats->count == 0)
+        statsAdd(stats, 0);
+
+    pos = lineString(0, "JARVIS_BENCH,");
+    pos = lineString(pos, name);
+    g_Line[pos++] = ',';
+    pos = lineNumber(pos, param);
+    g_Line[pos++] = ',';
+    pos = lineNumber(pos, stats->count);
+    g_Line[pos++] = ',';
+    pos = lineNumber(pos, stats->min);
+    g_Line[pos++] = ',';
+    pos = lineNumber(pos, stats->sum / stats->count);
+    g_Line[pos++] = ',';
+    pos = lineNumber(pos, stats->max);
+    g_Line[pos++] = '\n';
+    g_Line[pos] = '\0';
+
+    Bench_semihost(SEMIHOST_WRITE0, (uint32_t)g_Line);
+}
+
+
+/*******************************************************************************
+ *                          Helper Threads
+ ******************************************************************************/
+/* Suspends itself for the whole run, fills the delay list */
+static void sleeperThread (void)
+{
+    while (1)
+        Thread_Suspend(BENCH_FAR_DELAY);
+}
+
+/* Second half of the semaphore ping-pong */
+static void pongThread (void)
+{
+    while (1)
+    {
+        SemaphorePend(&g_Ping, WAIT_FOREVER);
+        SemaphorePost(&g_Pong);
+    }
+}
+
+/* Drains g_Queue */
+static void consumerThread (void)
+{
+    uint32_t item;
+
+    while (1)
+        QueueReceiveTimeout(g_Queue, &item, WAIT_FOREVER);
+}
+
+/* Measures the switch that brought it here, then yields back */
+static void yieldThread (void)
+{
+    while (g_YieldRunning)
+    {
+        statsAdd(&g_Stats, benchElapsed(g_YieldStamp, benchNow()));
+        Thread_Yield();
+    }
+}
+
+static ThreadHandle_t helperCreate (uint8_t Idx, void(*Thread)(void), uint8_t priority)
+{
+    return ThreadCreateStatic((uint8_t *)"Helper", Thread, priority, g_HelperStacks[Idx], BENCH_HELPER_STACK);
+}
+
+
+/*******************************************************************************
+ *                          Measurements
+ ******************************************************************************/
+/* LoadNextThread alone. The benchmark thread is the only one at its
+ * priority, so it picks itself again */
+static void benchLoadNextThread (void)
+{
+    uint32_t Idx, start;
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        sei();
+        start = benchNow();
+        LoadNextThread();
+        statsAdd(&g_Stats, benchElapsed(start, benchNow()));
+        cli();
+    }
+    benchReport("load_next_thread", 0, &g_Stats);
+}
+
+/* nextThread alone with 'ready' helper threads below the benchmark thread.
+ * The bitmap makes it independent of how many threads there are */
+static void benchNextThread (uint8_t ready)
+{
+    ThreadHandle_t threads[BENCH_HELPERS];
+    uint32_t Idx, start;
+
+    for (Idx = 0 ; Idx < ready ; Idx++)
+        threads[Idx] = helperCreate(Idx, sleeperThread, 1); /* Lower priority, they stay ready */
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        sei();
+        start = benchNow();
+        g_Selected = nextThread();
+        statsAdd(&g_Stats, benchElapsed(start, benchNow()));
+        cli();
+    }
+    benchReport("next_thread", ready, &g_Stats);
+
+    for (Idx = 0 ; Idx < ready ; Idx++)
+        Thread_Delete(threads[Idx]);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     scanNextThread
+ *
+ * [Description]:       Reference copy of the linear scan the ready bitmap
+ *                      replaced: walks every TCB for the highest priority
+ *                      ready one, count of them instead of NUM_OF_THREADS.
+ *
+ * [Arguments]:         TCB *ThreadsPtr, uint8_t count
+ * [Return]:            TCB *
+ *
+ *****************************************************************************/
+static TCB *scanNextThread (TCB *ThreadsPtr, uint8_t count)
+{
+    uint8_t Idx, nextIdx = 0;
+    uint8_t max = 0;
+
+    for (Idx = 0 ; Idx < count ; Idx++)
+    {
+        if (ThreadsPtr[Idx].status == READY && ThreadsPtr[Idx].priority > max)
+        {
+            max = ThreadsPtr[Idx].priority;
+            nextIdx = Idx;
+        }
+    }
+
+    return &ThreadsPtr[nextIdx];
+}
+
+/* The reference scan over 'count' ready threads of rising priorities, its
+ * worst case: every thread is a new maximum */
+static void benchScan (uint8_t count)
+{
+    uint32_t Idx, start;
+
+    for (Idx = 0 ; Idx < count ; Idx++)
+    {
+        g_ScanThreads[Idx].status = READY;
+        g_ScanThreads[Idx].priority = (Idx % (MAX_PRIORITIES - 1)) + 1;
+    }
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        sei();
+        start = benchNow();
+        g_Selected = scanNextThread(g_ScanThreads, count);
+        statsAdd(&g_Stats, benchElapsed(start, benchNow()));
+        cli();
+    }
+    benchReport("scan_next_thread", count, &g_Stats);
+}
+
+/* Whole PendSV_Handler run: exception entry, register save, LoadNextThread,
+ * restore and return */
+static void benchPendSV (void)
+{
+    uint32_t Idx, start;
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        start = benchNow();
+        triggerContextSwitch();
+        BENCH_SYNC();
+        statsAdd(&g_Stats, benchElapsed(start, benchNow()));
+    }
+    benchReport("pendsv_switch", 0, &g_Stats);
+}
+
+/* SysTick_Handler with 'sleepers' threads in the delay list. The pended tick
+ * also runs the PendSV_Handler it requests. The kernel part of the tick isn't
+ * called directly, every sample is a real tick that keeps Jarvis_Ticks, the
+ * delay list and the round-robin state consistent */
+static void benchTick (uint8_t sleepers)
+{
+    ThreadHandle_t threads[BENCH_HELPERS];
+    uint32_t Idx, start;
+
+    for (Idx = 0 ; Idx < sleepers ; Idx++)
+        threads[Idx] = helperCreate(Idx, sleeperThread, 1);
+
+    Thread_Suspend(1);                                      /* Let the sleepers reach the delay list */
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        start = benchNow();
+        ACCESS_REG(SysTick,INTCTRL) = INTCTRL_PENDSTSET;
+        BENCH_SYNC();
+        statsAdd(&g_Stats, benchElapsed(start, benchNow()));
+    }
+    benchReport("systick_handler", sleepers, &g_Stats);
+
+    for (Idx = 0 ; Idx < sleepers ; Idx++)
+        Thread_Delete(threads[Idx]);
+}
+
+/* Cycles from the tick that ends a one tick suspension to the thread running */
+static void benchSuspendLatency (void)
+{
+    uint32_t Idx;
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_LATENCY_SAMPLES ; Idx++)
+    {
+        Thread_Suspend(1);
+        statsAdd(&g_Stats, ACCESS_REG(SysTick,STRELOAD) - ACCESS_REG(SysTick,STCURRENT));
+    }
+    benchReport("suspend_resume_latency", 0, &g_Stats);
+}
+
+/* Thread_Yield handing the processor to another thread of the same priority */
+static void benchYield (void)
+{
+    ThreadHandle_t partner;
+    uint32_t Idx;
+
+    statsReset(&g_Stats);
+    g_YieldRunning = 1;
+    partner = helperCreate(0, yieldThread, BENCH_PRIORITY);
+
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        g_YieldStamp = benchNow();
+        Thread_Yield();
+    }
+
+    g_YieldRunning = 0;
+    Thread_Join(partner, WAIT_FOREVER);
+    benchReport("thread_yield_switch", 0, &g_Stats);
+}
+
+/* SemaphorePost + SemaphorePend round trip through a second thread */
+static void benchPingPong (void)
+{
+    ThreadHandle_t pong;
+    uint32_t Idx, start;
+
+    SemaphoreCreateBinary(&g_Ping);
+    SemaphoreCreateBinary(&g_Pong);
+    SemaphorePend(&g_Ping, 0);                              /* Start both empty */
+    SemaphorePend(&g_Pong, 0);
+
+    pong = helperCreate(0, pongThread, BENCH_PRIORITY);
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        start = benchNow();
+        SemaphorePost(&g_Ping);
+        SemaphorePend(&g_Pong, WAIT_FOREVER);
+        statsAdd(&g_Stats, benchElapsed(start, benchNow()));
+    }
+    benchReport("semaphore_round_trip", 0, &g_Stats);
+
+    Thread_Delete(pong);
+}
+
+/* Cycles per item written by this thread and received by another */
+static void benchQueue (uint32_t length)
+{
+    ThreadHandle_t consumer;
+    uint32_t Idx, item, start;
+
+    g_Queue = QueueCreateStatic(length, sizeof(uint32_t), &g_QueueBuffer, g_QueueStorage);
+    consumer = helperCreate(0, consumerThread, BENCH_PRIORITY);
+
+    statsReset(&g_Stats);
+    for (Idx = 0 ; Idx < BENCH_SAMPLES ; Idx++)
+    {
+        start = benchNow();
+        for (item = 0 ; item < BENCH_QUEUE_ITEMS ; item++)
+            QueueWriteTimeout(g_Queue, item, WAIT_FOREVER);
+        statsAdd(&g_Stats, benchElapsed(start, benchNow()) / BENCH_QUEUE_ITEMS);
+    }
+    benchReport("queue_item", length, &g_Stats);
+
+    Thread_Delete(consumer);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     benchThread
+ *
+ * [Description]:       Runs every measurement, then stops the application
+ *                      through semihosting (QEMU exits).
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+static void benchThread (void)
+{
+    uint32_t Idx;
+
+    benchInitCycles();
+
+#if (BENCH_USE_DWT == 1)
+    Bench_semihost(SEMIHOST_WRITE0, (uint32_t)"JARVIS_BENCH_CLOCK,dwt\n");
+#else
+    Bench_semihost(SEMIHOST_WRITE0, (uint32_t)"JARVIS_BENCH_CLOCK,systick\n");
+#endif
+    Bench_semihost(SEMIHOST_WRITE0, (uint32_t)"JARVIS_BENCH,name,param,samples,min,avg,max\n");
+
+    benchLoadNextThread();
+
+    for (Idx = 0 ; Idx <= BENCH_HELPERS ; Idx++)
+        benchNextThread(Idx);
+
+    for (Idx = 0 ; Idx < sizeof(g_ScanCounts) / sizeof(g_ScanCounts[0]) ; Idx++)
+        benchScan(g_ScanCounts[Idx]);
+
+    benchPendSV();
+
+    for (Idx = 0 ; Idx <= BENCH_HELPERS ; Idx++)
+        benchTick(Idx);
+
+    benchSuspendLatency();
+    benchYield();
+    benchPingPong();
+
+    for (Idx = 0 ; Idx < sizeof(g_QueueLengths) / sizeof(g_QueueLengths[0]) ; Idx++)
+        benchQueue(g_QueueLengths[Idx]);
+
+    Bench_semihost(SEMIHOST_WRITE0, (uint32_t)"JARVIS_BENCH_DONE\n");
+    Bench_semihost(SEMIHOST_EXIT, SEMIHOST_EXIT_OK);
+
+    while (1);
+}
+
+
+int main (void)
+{
+    ThreadCreateStatic((uint8_t *)"Bench", benchThread, BENCH_PRIORITY, g_BenchStack, BENCH_STACK_SIZE);
+
+    JARVIS_initKernel();
+
+    while (1);  /* UNREACHABLE CODE */
+}
@@ -0,0 +1,67 @@
+/******************************************************************************
+ * [File Name]:     JarvisOS_bench.h
+ *
+ * [Description]:   Kernel Benchmark Application Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _JARVISOS_BENCH_H
+#define _JARVISOS_BENCH_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+
+/*******************************************************************************
+ *                          Cycle Counter Registers
+ ******************************************************************************/
+#define DEMCR               0xE000EDFC          /* Debug Exception and Monitor Control */
+#define DEMCR_TRCENA        0x01000000          /* Enables the DWT unit */
+
+#define DWT                 0xE0001000
+#define DWT_CTRL            0x000
+#define DWT_CYCCNT          0x004
+#define DWT_CTRL_CYCCNTENA  0x00000001          /* Cycle counter enable */
+#define DWT_CTRL_NOCYCCNT   0x02000000          /* Read only, cycle counter not implemented */
+
+
+/*******************************************************************************
+ *                          Benchmark Settings
+ ******************************************************************************/
+/* 1: Time with the DWT cycle counter. 0: Time with the SysTick counter, for
+ * targets without DWT (QEMU doesn't model it) */
+#ifndef BENCH_USE_DWT
+#define BENCH_USE_DWT           1
+#endif
+
+#define BENCH_SAMPLES           64              /* Samples taken by each measurement */
+#define BENCH_LATENCY_SAMPLES   16              /* Suspend / resume samples, one Quanta each */
+#define BENCH_QUEUE_ITEMS       32              /* Items moved per queue throughput sample */
+#define BENCH_PRIORITY          4               /* Benchmark and helper threads priority */
+#define BENCH_STACK_SIZE        256             /* Benchmark thread stack in words */
+#define BENCH_HELPER_STACK      128             /* Helper threads stack in words */
+#define BENCH_FAR_DELAY         1000000         /* Suspension that never ends during a run */
+#define BENCH_SCAN_MAX          32              /* Reference TCBs walked by the linear scan */
+
+/* ARM semihosting operations, served by QEMU (-semihosting) or a debugger */
+#define SEMIHOST_WRITE0         0x04            /* Print a null terminated string */
+#define SEMIHOST_EXIT           0x18            /* Stop the application */
+#define SEMIHOST_EXIT_OK        0x20026         /* ADP_Stopped_ApplicationExit */
+
+typedef struct{
+    uint32_t        count;
+    uint32_t        min;
+    uint32_t        max;
+    uint32_t        sum;
+}Bench_Stats;
+
+
+/*******************************************************************************
+ *                          Functions Prototypes.
+ ******************************************************************************/
+uint32_t Bench_semihost (uint32_t operation, uint32_t argument);   /* bench_semihost.asm */
+
+
+#endif
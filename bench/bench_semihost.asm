@@ -0,0 +1,17 @@
+; [Filename]:		bench_semihost.asm
+; [Description]:	ARM semihosting call used by the benchmark application to print
+;					its results and to stop, under QEMU or a debugger
+; [Engineer]:		Hesham Khaled
+
+			.thumb										;Execute the code in Thumb Mode
+			.def	Bench_semihost
+
+; [Function Name]:	Bench_semihost
+; [Description]:	R0 = Semihosting operation, R1 = Argument. Returns R0.
+	.align 4
+Bench_semihost: .asmfunc
+	BKPT	#0xAB				; Semihosting request
+	BX		LR					; Return
+				.endasmfunc
+
+.end
@@ -11,15 +11,39 @@
 #ifndef _JARVISOS_CONFIG_H
 #define _JARVISOS_CONFIG_H
 
+#ifndef NULL
 #define NULL (void*) 0
+#endif
 #define MS_TO_TICKS( xTimeInMs ) ( ( uint32_t ) ( ( ( uint32_t ) ( xTimeInMs ) * ( uint32_t ) (F_CPU) ) / ( uint32_t ) 1000 ) )
 
 #define F_CPU                   16000000
 #define NUM_OF_THREADS          3
-#define STACK_SIZE              100
+#define MAX_PRIORITIES          32            /* Priority levels (up to 32), 0 is reserved for stateIdle */
+#define STACK_SIZE              100           /* Default thread stack in words, when ThreadCreate is given 0 */
+#define IDLE_STACK_SIZE         48            /* stateIdle stack in words */
+#define STACK_OVERFLOW_CHECK    0             /* 1: Check the stack guard word on every switch, calls StackOverflowHook */
 #define QUANTA                  100
+#define TIME_SLICE_TICKS        1             /* Base time slice in ticks, Thread_SetTimeSlice weights it */
 #define THREAD_ID_MAX_LENGTH    15
+#define THREAD_REGISTRY         1             /* 1: Keep a name to handle registry for Thread_GetHandle */
+#define THREAD_NOTIFICATIONS    1             /* 1: Give every thread a 32-bit notification value (notify.h) */
 #define port_MAX_DELAY          2
+#define TICKLESS_IDLE           0             /* 1: Stop SysTick while only stateIdle is ready */
+#define DYNAMIC_ALLOCATION      1             /* 0: Remove every heap allocating API (static creation only) */
+#define HEAP_SIZE               4096          /* Kernel heap size in bytes, used when DYNAMIC_ALLOCATION is 1 */
+#define TRACE_ENABLE            0             /* 1: Record kernel events in the g_Trace ring (trace.h) */
+#define TRACE_BUFFER_SIZE       256           /* Trace records kept, a power of two, 12 bytes each */
+#define RUNTIME_STATS           0             /* 1: Account the processor time of every thread (Thread_GetRunStats) */
+#define RUNTIME_STATS_BUCKETS   4             /* Sliding window length in buckets */
+#define RUNTIME_STATS_BUCKET_TICKS 10         /* Bucket length in ticks, the window must fit the 32-bit timestamp */
+#define QUEUE_SETS              0             /* 1: Queues and semaphores can join a queue set (queueset.h) */
+#define SOFTWARE_TIMERS         0             /* 1: Software timers, their callbacks run in a daemon thread (timer.h) */
+#define TIMER_DAEMON_PRIORITY   (MAX_PRIORITIES - 1)  /* Timer callbacks priority */
+#define TIMER_DAEMON_STACK_SIZE 128           /* Timer daemon stack in words, shared by every callback */
+#ifndef EDF_SCHEDULING                        /* Can be set from the command line (host tests) */
+#define EDF_SCHEDULING          0             /* 1: Threads of priority EDF_PRIORITY are scheduled Earliest Deadline First */
+#endif
+#define EDF_PRIORITY            8             /* Priority of the EDF band, fixed priorities above it preempt it */
 
 
 #endif
@@ -14,7 +14,9 @@
 #include <stdint.h>
 #include "SysTick.h"
 #include "JarvisOS_CONFIG.h"
+#include "JarvisOS_port.h"
 #include "common_funs.h"
+#include "runstats.h"
 
 
 /*******************************************************************************
@@ -22,37 +24,188 @@
  ******************************************************************************/
 typedef enum
 {
-    READY,BLOCKED,SUSPENDED,RUNNING
+    READY,BLOCKED,SUSPENDED,RUNNING,PENDING,TERMINATED
 }Thread_Status;
 
-typedef struct{
+typedef enum
+{
+    WAIT_SUCCESS,WAIT_TIMEOUT
+}Wait_Result;
+
+typedef enum
+{
+    THREAD_SUCCESS,ERROR_THREAD_TIMEOUT,ERROR_THREAD_INVALID
+}Thread_ErrorCode;
+
+struct xMUTEX;
+struct xMSGBUFFER;
+struct TCB;
+
+/* Threads pending on a kernel object, highest priority first */
+typedef struct WaitList{
+    struct TCB      *head;
+}WaitList;
+
+typedef struct TCB{
     int32_t         *stackPtr;
+    int32_t         *stackBase;                 /* Lowest word of the thread stack */
+    uint32_t        stackSize;                  /* Stack size in words */
     uint8_t         ThreadID[THREAD_ID_MAX_LENGTH];
-    uint8_t         priority;
+    uint8_t         priority;                   /* Effective priority, raised by priority inheritance */
+    uint8_t         basePriority;               /* Priority assigned by ThreadCreate */
     Thread_Status   status;
     uint32_t        delayTime;
+    struct TCB      *next;                      /* Next thread in its ready list or in the delay list */
+    struct TCB      *prev;                      /* Previous thread in its ready list or in the delay list */
+    struct TCB      *eventNext;                 /* Next thread pending on the same kernel object */
+    struct TCB      *eventPrev;                 /* Previous thread pending on the same kernel object */
+    struct WaitList *eventList;                 /* Wait list of the object the thread is pending on */
+    uint8_t         waitResult;                 /* Wait_Result of the last pend */
+    uint32_t        eventData;                  /* Item handed over with the wake-up */
+    void            *eventBuffer;               /* Caller buffer of the pending operation */
+    struct xMUTEX   *mutexesHeld;               /* Mutexes owned by the thread */
+    struct xMUTEX   *blockingMutex;             /* Mutex the thread is waiting for */
+    struct xMSGBUFFER *msgBuffer;               /* Message buffer the thread is copying a message in or out of */
+    uint32_t        msgOffset;                  /* Header offset of that message */
+    WaitList        joinWaiters;                /* Threads waiting in Thread_Join for this one to end */
+    uint8_t         heapStack;                  /* 1 if the stack was taken from the kernel heap */
+    uint8_t         sliceWeight;                /* Time slice in multiples of TIME_SLICE_TICKS */
+    uint32_t        sliceLeft;                  /* Ticks left in the current slice, kept while not running */
+    uint8_t         slot;                       /* Index of the TCB, names the thread in traces */
+#if (THREAD_NOTIFICATIONS == 1)
+    volatile uint32_t notifyValue;              /* Notification value, changed by Thread_Notify */
+    volatile uint8_t notifyPending;             /* 1 once notified, until the thread takes or waits */
+    WaitList        notifyWait;                 /* Only ever holds the thread itself, waiting for a notification */
+#endif
+#if (EDF_SCHEDULING == 1)
+    uint32_t        deadline;                   /* Absolute deadline tick of the current job */
+    uint32_t        relativeDeadline;           /* 0 if the thread has no declared deadline */
+    uint32_t        period;                     /* Release period in ticks, 0 if aperiodic */
+    uint32_t        release;                    /* Release tick of the current job */
+    uint32_t        deadlineMisses;             /* Jobs completed after their deadline */
+    uint8_t         heapIndex;                  /* Position in the EDF ready heap */
+#endif
+#if (RUNTIME_STATS == 1)
+    RunStats        runStats;                   /* Processor time used by the thread */
+#endif
 }TCB;
 
+/* Handle returned by ThreadCreate and taken by the thread control APIs */
+typedef TCB *ThreadHandle_t;
+
+#if (RUNTIME_STATS == 1)
+/* Thread_GetRunStats entry. Times are in PORT_TIMESTAMP units */
+typedef struct{
+    ThreadHandle_t  thread;
+    uint64_t        runTime;                    /* Since the thread was created */
+    uint32_t        switches;                   /* Times the thread was switched in */
+    uint16_t        cpuLoad;                    /* Share of the window, in hundredths of a percent */
+}Thread_RunStats;
+
+typedef struct{
+    uint64_t        upTime;                     /* Since JARVIS_initKernel */
+    uint64_t        idleTime;                   /* Spent in stateIdle */
+    uint32_t        switches;                   /* Context switches */
+    uint32_t        windowTime;                 /* Length of the sliding window */
+    uint16_t        cpuLoad;                    /* Busy share of the window, in hundredths of a percent */
+}System_RunStats;
+#endif
+
+/* Timeout value to pend on a kernel object without a time limit */
+#define WAIT_FOREVER                    0xFFFFFFFF
+
+/* Wrap-safe check that tick count 'now' has reached or passed 'deadline' */
+#define TICK_REACHED(now, deadline)     ((int32_t)((uint32_t)(now) - (uint32_t)(deadline)) >= 0)
+
+/* Every unused stack word holds this value */
+#define STACK_FILL_PATTERN              ((int32_t)0xA5A5A5A5)
+
+/* Smallest stack accepted by ThreadCreate: the 16 word initial frame plus
+ * room for the first function calls */
+#define STACK_MIN_SIZE                  32
+
+#if (IDLE_STACK_SIZE < STACK_MIN_SIZE)
+#error "Jarvis-OS: IDLE_STACK_SIZE is below STACK_MIN_SIZE"
+#endif
+
+#if (MAX_PRIORITIES > 32)
+#error "Jarvis-OS: MAX_PRIORITIES can't exceed the 32-bit ready bitmap"
+#endif
+
+#if (TIME_SLICE_TICKS == 0)
+#error "Jarvis-OS: TIME_SLICE_TICKS must be at least one tick"
+#endif
+
+#if (EDF_SCHEDULING == 1) && (EDF_PRIORITY == 0 || EDF_PRIORITY >= MAX_PRIORITIES)
+#error "Jarvis-OS: EDF_PRIORITY must be between 1 and MAX_PRIORITIES - 1"
+#endif
+
+/*******************************************************************************
+ *                          Kernel Globals
+ ******************************************************************************/
+extern TCB *g_curr_running_thread;
+
+
 /*******************************************************************************
  *                          Private Functions Prototypes.
  ******************************************************************************/
-void JARVIS_initStack (uint8_t);
+void JARVIS_initStack (TCB *thread, int32_t *stack, uint32_t stackSize, void(*Thread)(void));
 void Scheduler_init (void);
 void stateIdle (void);
-void Generate_stateIdle (uint8_t Idx);
+void suppressTicksAndSleep (void);
+void Generate_stateIdle (void);
+void reapThreads (void);
 void LoadNextThread(void);
 void checkSuspendedState (void);
-uint8_t nextThreadIndex (TCB *ThreadsPtr);
+void readyListInsert (TCB *thread);
+void readyListRemove (TCB *thread);
+void delayListInsert (TCB *thread);
+void delayListRemove (TCB *thread);
+void waitListInit (WaitList *list);
+void waitListInsert (WaitList *list, TCB *thread);
+void waitListRemove (TCB *thread);
+uint8_t waitOnList (WaitList *list, uint32_t timeout);
+TCB *wakeFromList (WaitList *list, uint32_t data);
+void wakeThread (TCB *thread, uint32_t data);
+void threadSetPriority (TCB *thread, uint8_t priority);
+TCB *nextThread (void);
+uint8_t threadOutranks (TCB *thread);
+void triggerContextSwitch (void);
+void sei (void);
+void cli (void);
 
 
 /*******************************************************************************
  *                          Public Functions Prototypes.
  ******************************************************************************/
 void JARVIS_initKernel (void);
-void Thread_Block (uint8_t ThreadID[THREAD_ID_MAX_LENGTH]);
-void Thread_Resume (uint8_t ThreadID[THREAD_ID_MAX_LENGTH]);
+uint32_t JARVIS_GetTicks (void);
+#if (STACK_OVERFLOW_CHECK == 1)
+void StackOverflowHook (ThreadHandle_t thread);        /* Supplied by the application */
+#endif
+void Thread_Block (ThreadHandle_t thread);
+void Thread_Resume (ThreadHandle_t thread);
 void Thread_Suspend (uint32_t);
-void ThreadCreate(uint8_t ThreadID[THREAD_ID_MAX_LENGTH],void(*Thread)(void), uint8_t a_priority);
+void Thread_Yield (void);
+#if (DYNAMIC_ALLOCATION == 1)
+ThreadHandle_t ThreadCreate(const uint8_t *ThreadID,void(*Thread)(void), uint8_t a_priority, uint32_t stackSize);
+#endif
+ThreadHandle_t ThreadCreateStatic(const uint8_t *ThreadID,void(*Thread)(void), uint8_t a_priority,
+                                  int32_t *stack, uint32_t stackSize);
+uint32_t Thread_GetStackHighWaterMark (ThreadHandle_t thread);
+void Thread_Exit (void);
+void Thread_Delete (ThreadHandle_t thread);
+uint8_t Thread_Join (ThreadHandle_t thread, uint32_t timeout);
+uint8_t Thread_SetTimeSlice (ThreadHandle_t thread, uint8_t weight);
+ThreadHandle_t Thread_GetCurrent (void);
+#if (RUNTIME_STATS == 1)
+uint32_t Thread_GetRunStats (Thread_RunStats *threads, uint32_t maxThreads, System_RunStats *system);
+#endif
+#if (EDF_SCHEDULING == 1)
+uint8_t Thread_SetDeadline (ThreadHandle_t thread, uint32_t deadline, uint32_t period);
+void Thread_WaitNextPeriod (void);
+uint32_t Thread_GetDeadlineMisses (ThreadHandle_t thread);
+#endif
 
 
 #endif
@@ -0,0 +1,156 @@
+/******************************************************************************
+ *
+ * [File Name]:     JarvisOS_port.h
+ *
+ * [Description]:   Compiler and Processor specific definitions used by the
+ *                  Kernel to port Jarvis-OS to ARM Cortex-M4 Processor, or to
+ *                  a POSIX host when JARVIS_PORT_POSIX is defined
+ *                  (port/posix/JarvisOS_port_posix.c)
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _JARVISOS_PORT_H
+#define _JARVISOS_PORT_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          Count Leading Zeros (CLZ)
+ ******************************************************************************/
+/* Single cycle CLZ instruction. Used by the scheduler to find the highest
+ * ready priority in the ready bitmap. Argument must never be zero. */
+#if defined(__TI_COMPILER_VERSION__)
+#define PORT_CLZ(x)             ((uint8_t)_norm(x))
+#elif defined(__GNUC__)
+#define PORT_CLZ(x)             ((uint8_t)__builtin_clz(x))
+#else
+#error "Jarvis-OS: PORT_CLZ is not defined for this compiler"
+#endif
+
+/* Highest set bit index of a non-zero 32-bit bitmap */
+#define PORT_HIGHEST_BIT(x)     ((uint8_t)(31 - PORT_CLZ(x)))
+
+
+
+/*******************************************************************************
+ *                          Exclusive Access (LDREX / STREX)
+ ******************************************************************************/
+/* PORT_DMB: Data Memory Barrier, orders a data write before the index that
+ * publishes it.
+ * Port_CompareAndSwap: Atomically replaces *ptr with desired if it still holds
+ * expected. Returns 1 on success. Safe against ISRs of any priority without
+ * disabling interrupts. */
+#if defined(__TI_COMPILER_VERSION__)
+#define PORT_DMB()              __asm(" DMB")
+
+static inline uint8_t Port_CompareAndSwap (volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+    do
+    {
+        if (__ldrex((void *)ptr) != expected)
+        {
+            __clrex();
+            return 0;
+        }
+    } while (__strex(desired, (void *)ptr) != 0);           /* Retry if an ISR touched the address meanwhile */
+
+    return 1;
+}
+#elif defined(__GNUC__)
+#define PORT_DMB()              __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+static inline uint8_t Port_CompareAndSwap (volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+    /* Compiles to an LDREX / STREX loop on ARMv7-M */
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+#endif
+
+
+/*******************************************************************************
+ *                          Interrupts & Context Switch
+ ******************************************************************************/
+/* PORT_DISABLE_INTERRUPTS / PORT_ENABLE_INTERRUPTS: Mask and unmask the
+ * interrupts that enter the kernel.
+ * PORT_TRIGGER_SWITCH: Requests a context switch, carried out once no
+ * interrupt and no critical section is active.
+ * Port_InitStack: Builds the frame a new thread is started from below the
+ * 8-byte aligned stack top. The thread returns to Exit. Returns the thread's
+ * initial stack pointer. */
+#if defined(JARVIS_PORT_POSIX)
+
+/* Host tick period in microseconds, one kernel tick per period */
+#ifndef PORT_POSIX_TICK_US
+#define PORT_POSIX_TICK_US      1000
+#endif
+
+/* 1: the tick counts the process' CPU time (ITIMER_PROF) instead of the wall
+ * clock, so host stalls don't eat into the threads' time, for timing tests */
+#ifndef PORT_POSIX_TICK_CPU
+#define PORT_POSIX_TICK_CPU     0
+#endif
+
+/* Native stack of each simulated thread, the kernel stack only holds its context pointer */
+#ifndef PORT_POSIX_STACK_SIZE
+#define PORT_POSIX_STACK_SIZE   (64 * 1024)
+#endif
+
+#define PORT_DISABLE_INTERRUPTS()   Port_DisableInterrupts()
+#define PORT_ENABLE_INTERRUPTS()    Port_EnableInterrupts()
+#define PORT_TRIGGER_SWITCH()       Port_TriggerContextSwitch()
+
+void Port_DisableInterrupts (void);
+void Port_EnableInterrupts (void);
+void Port_TriggerContextSwitch (void);
+int32_t *Port_InitStack (void *owner, int32_t *top, void(*Thread)(void), void(*Exit)(void));
+
+#else
+
+#define PORT_DISABLE_INTERRUPTS()   __asm(" CPSID I")
+#define PORT_ENABLE_INTERRUPTS()    __asm(" CPSIE I")
+#define PORT_TRIGGER_SWITCH()       (ACCESS_REG(SysTick,INTCTRL) = INTCTRL_PENDSVSET)
+
+static inline int32_t *Port_InitStack (void *owner, int32_t *top, void(*Thread)(void), void(*Exit)(void))
+{
+    (void)owner;                                            /* The frame lives in the thread stack itself */
+
+    top[-1] = 0x1000000;                                    /* xPSR: Thumb mode */
+    top[-2] = (int32_t)(Thread) & ~1;                       /* PC: the frame holds it without the Thumb bit */
+    top[-3] = (int32_t)(Exit);                              /* LR */
+
+    return top - 16;                                        /* R4-R11 below the hardware frame R0-R3, R12, LR, PC, xPSR */
+}
+
+#endif
+
+
+/*******************************************************************************
+ *                          Timestamp Counter
+ ******************************************************************************/
+/* PORT_TIMESTAMP: Free running 32-bit counter ticking at PORT_TIMESTAMP_HZ,
+ * read by the trace buffer. Port_TimestampInit starts it. */
+#if defined(JARVIS_PORT_POSIX)
+
+#define PORT_TIMESTAMP_HZ       1000000                     /* Host monotonic clock in microseconds */
+#define PORT_TIMESTAMP()        Port_Timestamp()
+
+void Port_TimestampInit (void);
+uint32_t Port_Timestamp (void);
+
+#else
+
+#define PORT_TIMESTAMP_HZ       F_CPU                       /* DWT cycle counter */
+#define PORT_TIMESTAMP()        (*((volatile uint32_t *)0xE0001004))
+
+static inline void Port_TimestampInit (void)
+{
+    *((volatile uint32_t *)0xE000EDFC) |= 0x01000000;       /* DEMCR: TRCENA, powers the DWT unit */
+    *((volatile uint32_t *)0xE0001000) |= 0x00000001;       /* DWT_CTRL: CYCCNTENA */
+}
+
+#endif
+
+
+#endif
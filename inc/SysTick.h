@@ -20,6 +20,7 @@
  ******************************************************************************/
 #define SysTick             0xE000E000
 #define LEAST_PRIORITY      0xE0000000            /* Priority = 7 in ARM Cortex M4 */
+#define PENDSV_LEAST_PRIORITY 0x00E00000          /* PendSV Priority = 7 in ARM Cortex M4 */
                                                   /* Registers offset */
 
 /* CTCTRL: SysTick Control Register.
@@ -47,17 +48,31 @@
 #define STCURRENT   0x018
 
 /* SYSPRI3:
- * Bit[29]~Bit[30]: Responsible for changing SysTick Timer Priority from 0 ~ 7 */
+ * Bit[21]~Bit[23]: Responsible for changing PendSV Priority from 0 ~ 7
+ * Bit[29]~Bit[31]: Responsible for changing SysTick Timer Priority from 0 ~ 7 */
 #define SYSPRI3     0xD20
 
-/* INTCTRL: Responsible for Triggering SysTick_Handler */
+/* INTCTRL: Responsible for Triggering SysTick_Handler and PendSV_Handler */
 #define INTCTRL     0xD04
 
+/* STCTRL and INTCTRL bit fields */
+#define STCTRL_ENABLE       0x00000001      /* Counter Enable */
+#define STCTRL_COUNT        0x00010000      /* Counter reached 0 since last read */
+#define INTCTRL_PENDSVSET   0x10000000      /* Set PendSV pending */
+#define INTCTRL_PENDSTSET   0x04000000      /* Set SysTick pending */
+#define INTCTRL_PENDSTCLR   0x02000000      /* Clear SysTick pending */
+#define INTCTRL_VECPEND     0x000FF000      /* Highest priority pending interrupt vector */
+
+/* Maximum value the 24-bit SysTick down counter can be loaded with */
+#define SYSTICK_MAX_RELOAD  0x00FFFFFF
+
 
 /*******************************************************************************
  *                          Function Prototypes
  ******************************************************************************/
 void SysTick_init (void);
+void SysTick_Handler (void);
+uint32_t SysTick_sleep (uint32_t idleTicks);
 
 
 #endif
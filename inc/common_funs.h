@@ -2,8 +2,11 @@
 #define _COMMON_FUNS_H
 
 #include <stdint.h>
+#include "JarvisOS_CONFIG.h"
 
 int8_t strcmp(const uint8_t *Str_1, const uint8_t *Str_2);
 void strcpy (uint8_t *destination, const uint8_t *source);
+void strncpy (uint8_t *destination, const uint8_t *source, uint32_t length);
+int8_t strncmp (const uint8_t *Str_1, const uint8_t *Str_2, uint32_t length);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,52 @@
+/******************************************************************************
+ * [File Name]:     eventgroup.h
+ *
+ * [Description]:   Event Groups Implementation Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _EVENTGROUP_H
+#define _EVENTGROUP_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+typedef enum {
+    EVENTGROUP_SUCCESS,
+    ERROR_EVENTGROUP_TIMEOUT,
+    ERROR_EVENTGROUP_INVALID
+}EventGroup_ErrorCode;
+
+/* EventGroupWait options, OR them together */
+#define EVENT_WAIT_ANY          0x00        /* Satisfied by any of the bits */
+#define EVENT_WAIT_ALL          0x01        /* Satisfied once every bit is set */
+#define EVENT_CLEAR_ON_EXIT     0x02        /* Clear the bits waited for when satisfied */
+
+typedef struct{
+    volatile uint32_t   bits;               /* 32 event flags */
+    WaitList            waiters;            /* Threads waiting for a bit combination */
+}xEVENTGROUP;
+
+/* What a waiting thread waits for, pointed to by its eventBuffer */
+typedef struct{
+    uint32_t            bits;
+    uint8_t             options;
+}EventGroup_Wait;
+
+/* Definition of Event Group Handles */
+typedef xEVENTGROUP  EventGroupHandle_t;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+void EventGroupCreate (EventGroupHandle_t *group);
+uint32_t EventGroupSet (EventGroupHandle_t *group, uint32_t bits);
+uint32_t EventGroupClear (EventGroupHandle_t *group, uint32_t bits);
+uint32_t EventGroupGet (EventGroupHandle_t *group);
+uint8_t EventGroupWait (EventGroupHandle_t *group, uint32_t bits, uint8_t options,
+                        uint32_t *value, uint32_t timeout);
+
+#endif
@@ -0,0 +1,51 @@
+/******************************************************************************
+ * [File Name]:     heap.h
+ *
+ * [Description]:   TLSF (Two-Level Segregated Fit) Kernel Heap Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _HEAP_H
+#define _HEAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "JarvisOS_CONFIG.h"
+
+/* Allocation granularity and alignment in bytes */
+#define HEAP_ALIGN_LOG2         3
+#define HEAP_ALIGN              (1 << HEAP_ALIGN_LOG2)
+
+/* Second level: every power of two size range is split in 2^HEAP_SL_LOG2 lists */
+#define HEAP_SL_LOG2            4
+#define HEAP_SL_COUNT           (1 << HEAP_SL_LOG2)
+
+/* First level: sizes below 2^HEAP_FL_SHIFT share the first list row,
+ * the largest block handled is 2^HEAP_FL_MAX bytes */
+#define HEAP_FL_SHIFT           (HEAP_SL_LOG2 + HEAP_ALIGN_LOG2)
+#define HEAP_FL_MAX             16
+#define HEAP_FL_COUNT           (HEAP_FL_MAX - HEAP_FL_SHIFT + 1)
+
+#if (HEAP_SIZE >= (1UL << HEAP_FL_MAX))
+#error "Jarvis-OS: HEAP_SIZE is larger than the TLSF first level can index, raise HEAP_FL_MAX"
+#endif
+
+typedef struct{
+    uint32_t        totalBytes;                 /* Bytes usable for allocations */
+    uint32_t        freeBytes;                  /* Bytes currently free */
+    uint32_t        largestFreeBlock;           /* Largest single allocation that can succeed now */
+    uint32_t        fragmentation;              /* Percent of free bytes outside the largest free block */
+    uint32_t        highWaterMark;              /* Most bytes ever allocated at once, headers included */
+}HeapStats_t;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+void *HeapAlloc (size_t size);
+void HeapFree (void *ptr);
+void HeapGetStats (HeapStats_t *stats);
+
+#endif
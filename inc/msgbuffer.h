@@ -0,0 +1,57 @@
+/******************************************************************************
+ * [File Name]:     msgbuffer.h
+ *
+ * [Description]:   Variable Length Message Buffer Implementation Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _MSGBUFFER_H
+#define _MSGBUFFER_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+/* Every message is stored after a header of this many bytes: its length and its state */
+#define MSGBUF_HEADER_SIZE      3
+#define MSGBUF_MAX_MESSAGE      0xFFFF
+
+/* Storage bytes needed to hold 'count' messages of 'length' bytes each */
+#define MSGBUF_STORAGE_SIZE(count, length)  ((count) * ((length) + MSGBUF_HEADER_SIZE))
+
+typedef enum {
+    MSGBUF_SUCCESS,
+    ERROR_MSGBUF_FULL,
+    ERROR_MSGBUF_EMPTY,
+    ERROR_MSGBUF_TOO_LARGE,
+    ERROR_MSGBUF_TOO_SMALL
+}MsgBuffer_ErrorCode;
+
+typedef struct xMSGBUFFER{
+    uint8_t         *Data_Ptr;                  /* Caller supplied ring storage */
+    uint32_t        capacity;                   /* Storage size in bytes */
+    uint32_t        head;                       /* Offset of the oldest message header */
+    uint32_t        tail;                       /* Offset of the next free byte */
+    uint32_t        used;                       /* Bytes taken by headers and messages, reserved ones included */
+    uint32_t        ready;                      /* Messages copied in and not yet claimed by a receiver */
+    uint32_t        scanned;                    /* Bytes from head known to hold no ready message */
+    WaitList        sendWaiters;                /* Threads waiting for free space */
+    WaitList        receiveWaiters;             /* Threads waiting for a message */
+}xMSGBUFFER;
+
+/* Definition of Message Buffer Handles */
+typedef xMSGBUFFER   MsgBufferHandle_t;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+void MsgBufferCreate (MsgBufferHandle_t *buffer, uint8_t *storage, uint32_t size);
+uint8_t MsgBufferSend (MsgBufferHandle_t *buffer, const void *data, uint32_t length, uint32_t timeout);
+uint8_t MsgBufferReceive (MsgBufferHandle_t *buffer, void *data, uint32_t maxLength, uint32_t *length, uint32_t timeout);
+uint32_t MsgBufferNextLength (MsgBufferHandle_t *buffer);
+
+void MsgBuffer_AbortCopy (TCB *thread);
+
+#endif
@@ -0,0 +1,43 @@
+/******************************************************************************
+ * [File Name]:     mutex.h
+ *
+ * [Description]:   Priority Inheritance Mutex Implementation Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _MUTEX_H
+#define _MUTEX_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+typedef enum {
+    MUTEX_SUCCESS,
+    ERROR_MUTEX_TIMEOUT,
+    ERROR_MUTEX_NOT_OWNER
+}Mutex_ErrorCode;
+
+typedef struct xMUTEX{
+    TCB             *owner;                     /* Thread holding the mutex, NULL if free */
+    uint32_t        lockCount;                  /* Recursive lock depth of the owner */
+    WaitList        waiters;                    /* Threads waiting for the mutex */
+    struct xMUTEX   *nextHeld;                  /* Next mutex held by the same owner */
+}xMUTEX;
+
+/* Definition of Mutex Handles */
+typedef xMUTEX       MutexHandle_t;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+void MutexCreate (MutexHandle_t *mutex);
+uint8_t MutexLock (MutexHandle_t *mutex, uint32_t timeout);
+uint8_t MutexUnlock (MutexHandle_t *mutex);
+
+void Mutex_AbortWait (TCB *thread);
+void Mutex_ReleaseAll (TCB *thread);
+
+#endif
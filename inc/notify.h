@@ -0,0 +1,43 @@
+/******************************************************************************
+ * [File Name]:     notify.h
+ *
+ * [Description]:   Thread Notifications Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _NOTIFY_H
+#define _NOTIFY_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+#if (THREAD_NOTIFICATIONS == 1)
+
+typedef enum {
+    NOTIFY_SUCCESS,
+    ERROR_NOTIFY_TIMEOUT,
+    ERROR_NOTIFY_PENDING,
+    ERROR_NOTIFY_INVALID
+}Notify_ErrorCode;
+
+/* What Thread_Notify does to the notification value */
+typedef enum {
+    NOTIFY_INCREMENT,                       /* value + 1, value argument ignored (counting semaphore) */
+    NOTIFY_SET_BITS,                        /* value | bits (event flags) */
+    NOTIFY_OVERWRITE,                       /* value replaced (mailbox) */
+    NOTIFY_SET_IF_EMPTY                     /* value replaced unless a notification is still pending */
+}Notify_Action;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+uint8_t Thread_Notify (ThreadHandle_t thread, uint32_t value, uint8_t action);
+uint32_t Thread_NotifyTake (uint8_t clearOnExit, uint32_t timeout);
+uint8_t Thread_NotifyWait (uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t *value, uint32_t timeout);
+
+#endif
+
+#endif
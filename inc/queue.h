@@ -12,6 +12,8 @@
 
 #include <stdint.h>
 #include "JarvisOS_CONFIG.h"
+#include "JarvisOS_kernel.h"
+#include "queueset.h"
 
 typedef enum {
     SUCCESS,
@@ -20,24 +22,38 @@ typedef enum {
     ERROR_QUEUE_NULL
 }Queue_ErrorCode;
 
-typedef struct{
+typedef struct xQUEUE{
     uint32_t        *Data_Ptr;
     uint32_t        tail;
     uint32_t        head;
     uint32_t        length;
     uint8_t         size;
+    WaitList        sendWaiters;                /* Threads waiting for a free slot */
+    WaitList        receiveWaiters;             /* Threads waiting for an item */
+#if (QUEUE_SETS == 1)
+    QueueSetLink    setLink;                    /* Queue set membership */
+#endif
 }xQUEUE;
 
 /* Typedef to any created Queue Handle  */
 typedef xQUEUE*   QueueHandle_t;
 
+/* Words of item storage needed by a queue of 'length' items of 'size' bytes.
+ * Items are uint32_t words, so size must be 1 ~ 4 and every item takes one word */
+#define QUEUE_STORAGE_WORDS(length, size)   (length)
+
 
 /*******************************************************************************
  *                          Public Functions Prototypes.
  ******************************************************************************/
+#if (DYNAMIC_ALLOCATION == 1)
 QueueHandle_t QueueCreate(uint32_t length, uint8_t size);
+#endif
+QueueHandle_t QueueCreateStatic(uint32_t length, uint8_t size, xQUEUE *queueBuffer, uint32_t *storage);
 uint8_t QueueWrite(QueueHandle_t queue,uint32_t data);
 uint8_t QueueReceive(QueueHandle_t queue,uint32_t *var);
+uint8_t QueueWriteTimeout(QueueHandle_t queue, uint32_t data, uint32_t timeout);
+uint8_t QueueReceiveTimeout(QueueHandle_t queue, uint32_t *var, uint32_t timeout);
 uint8_t QueueIsEmpty (QueueHandle_t queue);
 uint8_t QueueIsFull (QueueHandle_t queue);
 
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * [File Name]:     queueset.h
+ *
+ * [Description]:   Queue Sets Implementation Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _QUEUESET_H
+#define _QUEUESET_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+typedef enum {
+    QUEUESET_SUCCESS,
+    ERROR_QUEUESET_TIMEOUT,
+    ERROR_QUEUESET_INVALID
+}QueueSet_ErrorCode;
+
+/* Kind of object a set member is */
+#define QUEUESET_MEMBER_QUEUE       0
+#define QUEUESET_MEMBER_SEMAPHORE   1
+
+struct xQUEUESET;
+
+/* Embedded in every queue and semaphore */
+typedef struct QueueSetLink{
+    struct xQUEUESET    *set;               /* Set the object belongs to, NULL if none */
+    struct QueueSetLink *next;              /* Next member in the set's ready list */
+    void                *object;            /* Queue or semaphore handle returned by QueueSetSelect */
+    uint8_t             type;               /* QUEUESET_MEMBER_QUEUE or QUEUESET_MEMBER_SEMAPHORE */
+    uint8_t             linked;             /* 1 while in the set's ready list */
+}QueueSetLink;
+
+typedef struct xQUEUESET{
+    QueueSetLink        *head;              /* Members that became ready, oldest first */
+    QueueSetLink        *tail;
+    WaitList            waiters;            /* Threads waiting in QueueSetSelect */
+}xQUEUESET;
+
+/* Definition of Queue Set Handles */
+typedef xQUEUESET    QueueSetHandle_t;
+
+#if (QUEUE_SETS == 1)
+
+/* Called by a member, inside its critical section, whenever it may have become ready */
+#define QUEUE_SET_NOTIFY(link)                      QueueSet_Notify(link)
+#define QUEUE_SET_LINK_INIT(link, object, type)     QueueSet_LinkInit((link), (object), (type))
+
+struct xQUEUE;
+struct xSEMAPHORE;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+void QueueSetCreate (QueueSetHandle_t *set);
+uint8_t QueueSetAddQueue (QueueSetHandle_t *set, struct xQUEUE *queue);
+uint8_t QueueSetAddSemaphore (QueueSetHandle_t *set, struct xSEMAPHORE *semaphore);
+uint8_t QueueSetRemoveQueue (QueueSetHandle_t *set, struct xQUEUE *queue);
+uint8_t QueueSetRemoveSemaphore (QueueSetHandle_t *set, struct xSEMAPHORE *semaphore);
+void *QueueSetSelect (QueueSetHandle_t *set, uint32_t timeout);
+
+void QueueSet_LinkInit (QueueSetLink *link, void *object, uint8_t type);
+void QueueSet_Notify (QueueSetLink *link);
+
+#else
+
+#define QUEUE_SET_NOTIFY(link)                      ((void)0)
+#define QUEUE_SET_LINK_INIT(link, object, type)     ((void)0)
+
+#endif
+
+#endif
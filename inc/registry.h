@@ -0,0 +1,36 @@
+/******************************************************************************
+ * [File Name]:     registry.h
+ *
+ * [Description]:   Thread Name Registry Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _REGISTRY_H
+#define _REGISTRY_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+#if (THREAD_REGISTRY == 1)
+
+/* Hash table slots, kept at twice the thread count so probe chains stay short */
+#define REGISTRY_SLOTS          (2 * NUM_OF_THREADS)
+
+
+/*******************************************************************************
+ *                          Private Functions Prototypes.
+ ******************************************************************************/
+void Registry_Add (TCB *thread);
+void Registry_Remove (TCB *thread);
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+ThreadHandle_t Thread_GetHandle (const uint8_t *ThreadID);
+
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+/******************************************************************************
+ * [File Name]:     ringbuf.h
+ *
+ * [Description]:   Lock-free Ring Buffer Implementation Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _RINGBUF_H
+#define _RINGBUF_H
+
+#include <stdint.h>
+#include "JarvisOS_CONFIG.h"
+#include "JarvisOS_port.h"
+
+/* Producer modes */
+#define RINGBUF_SPSC            0           /* One producer (thread or ISR), one consumer */
+#define RINGBUF_MPSC            1           /* Many producers (threads and ISRs of any priority), one consumer */
+
+typedef enum {
+    RINGBUF_SUCCESS,
+    ERROR_RINGBUF_FULL,
+    ERROR_RINGBUF_EMPTY,
+    ERROR_RINGBUF_LENGTH
+}RingBuf_ErrorCode;
+
+/* One ring slot. sequence tells producers and the consumer whose turn it is */
+typedef struct{
+    volatile uint32_t   sequence;
+    uint32_t            data;
+}RingBuf_Slot;
+
+typedef struct{
+    RingBuf_Slot        *Slots_Ptr;         /* Caller supplied slots, a power of two of them */
+    uint32_t            mask;               /* length - 1 */
+    volatile uint32_t   tail;               /* Next position to claim by a producer */
+    volatile uint32_t   head;               /* Next position to read, only moved by the consumer */
+    uint8_t             mode;
+}xRINGBUF;
+
+/* Definition of Ring Buffer Handles */
+typedef xRINGBUF     RingBufHandle_t;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+uint8_t RingBufCreate (RingBufHandle_t *ring, RingBuf_Slot *slots, uint32_t length, uint8_t mode);
+uint8_t RingBufWrite (RingBufHandle_t *ring, uint32_t data);
+uint8_t RingBufRead (RingBufHandle_t *ring, uint32_t *data);
+uint32_t RingBufCount (RingBufHandle_t *ring);
+
+#endif
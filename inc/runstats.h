@@ -0,0 +1,40 @@
+/******************************************************************************
+ *
+ * [File Name]:     runstats.h
+ *
+ * [Description]:   Run Time Accounting Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _RUNSTATS_H
+#define _RUNSTATS_H
+
+#include <stdint.h>
+#include "JarvisOS_CONFIG.h"
+
+/* Percentages are reported in hundredths, 10000 is the whole processor */
+#define RUNSTATS_PERCENT_FULL   10000
+
+/* Time spent by a thread (or the whole system) in PORT_TIMESTAMP units. The
+ * sliding window is the last RUNTIME_STATS_BUCKETS buckets plus the current one */
+typedef struct{
+    uint64_t        total;                      /* Since creation */
+    uint32_t        current;                    /* In the current bucket */
+    uint32_t        buckets[RUNTIME_STATS_BUCKETS];
+    uint32_t        switches;                   /* Times it was switched in */
+}RunStats;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+void RunStats_Reset (RunStats *stats);
+void RunStats_Charge (RunStats *stats, uint32_t elapsed);
+void RunStats_Rotate (RunStats *stats, uint8_t bucket);
+uint32_t RunStats_WindowTime (const RunStats *stats);
+uint16_t RunStats_Percent (uint32_t part, uint32_t whole);
+
+
+#endif
@@ -11,9 +11,25 @@
 #define _SEMAPHORE_H
 
 #include <stdint.h>
+#include "JarvisOS_kernel.h"
+#include "queueset.h"
+
+typedef enum {
+    SEMAPHORE_SUCCESS,
+    ERROR_SEMAPHORE_TIMEOUT
+}Semaphore_ErrorCode;
+
+typedef struct xSEMAPHORE{
+    uint32_t        count;                      /* Available tokens */
+    uint32_t        maxCount;                   /* Tokens limit, 1 for binary semaphores */
+    WaitList        waiters;                    /* Threads waiting for a token */
+#if (QUEUE_SETS == 1)
+    QueueSetLink    setLink;                    /* Queue set membership */
+#endif
+}xSEMAPHORE;
 
 /* Definition of Semaphore Handles */
-typedef uint32_t     SemaphoreHandle_t;
+typedef xSEMAPHORE   SemaphoreHandle_t;
 
 
 /*******************************************************************************
@@ -21,7 +37,7 @@ typedef uint32_t     SemaphoreHandle_t;
  ******************************************************************************/
 void SemaphoreCreateBinary (SemaphoreHandle_t *semaphore);
 void SemaphoreCreate (SemaphoreHandle_t *semaphore, uint32_t num_of_tokens);
-void SemaphorePend (SemaphoreHandle_t *semaphore, uint32_t ThreadDelay);
+uint8_t SemaphorePend (SemaphoreHandle_t *semaphore, uint32_t timeout);
 void SemaphorePost (SemaphoreHandle_t *semaphore);
 
 #endif
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * [File Name]:     sysconfig.h
+ *
+ * [Description]:   Static System Configuration Header File. Describes the
+ *                  const tables generated by tools/jarvis_config.py from a
+ *                  system description, and walked by SysConfig_Init.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _SYSCONFIG_H
+#define _SYSCONFIG_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+#include "queue.h"
+#include "semaphore.h"
+#include "timer.h"
+
+typedef enum {
+    SYSCONFIG_SUCCESS,
+    ERROR_SYSCONFIG_THREAD,
+    ERROR_SYSCONFIG_QUEUE,
+    ERROR_SYSCONFIG_TIMER
+}SysConfig_ErrorCode;
+
+/* Every table entry is const, so it stays in flash. Only the objects, stacks
+ * and handles they point to are in RAM */
+typedef struct{
+    const uint8_t       *name;
+    void                (*entry)(void);
+    uint8_t             priority;
+    int32_t             *stack;
+    uint32_t            stackSize;          /* In words */
+    ThreadHandle_t      *handle;            /* Receives the thread handle */
+}SysConfig_Thread;
+
+typedef struct{
+    uint32_t            length;
+    uint8_t             size;
+    xQUEUE              *queue;
+    uint32_t            *storage;           /* QUEUE_STORAGE_WORDS(length, size) words */
+    QueueHandle_t       *handle;
+}SysConfig_Queue;
+
+typedef struct{
+    SemaphoreHandle_t   *semaphore;
+    uint32_t            tokens;             /* Initial tokens */
+    uint8_t             binary;
+}SysConfig_Semaphore;
+
+#if (SOFTWARE_TIMERS == 1)
+typedef struct{
+    TimerHandle_t       *timer;
+    uint32_t            period;
+    uint8_t             mode;
+    void                (*callback)(TimerHandle_t *timer);
+    uint8_t             start;              /* 1: Started by SysConfig_Init */
+}SysConfig_Timer;
+#endif
+
+typedef struct{
+    const SysConfig_Thread      *threads;
+    uint32_t                    threadCount;
+    const SysConfig_Queue       *queues;
+    uint32_t                    queueCount;
+    const SysConfig_Semaphore   *semaphores;
+    uint32_t                    semaphoreCount;
+#if (SOFTWARE_TIMERS == 1)
+    const SysConfig_Timer       *timers;
+    uint32_t                    timerCount;
+#endif
+}SysConfig_System;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+uint8_t SysConfig_Init (const SysConfig_System *system);
+
+#endif
@@ -0,0 +1,30 @@
+/******************************************************************************
+ *
+ * [File Name]:     tickless.h
+ *
+ * [Description]:   Tickless Idle Tick Compensation Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _TICKLESS_H
+#define _TICKLESS_H
+
+#include <stdint.h>
+
+/* Result of a tickless sleep, in kernel ticks and SysTick cycles */
+typedef struct{
+    uint32_t        ticks;                      /* Tick interrupts that were skipped while sleeping */
+    uint32_t        nextTickCycles;             /* Cycles left until the next tick boundary */
+}Tickless_Compensation;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+uint32_t Tickless_sleepCycles (uint32_t currentCycles, uint32_t cyclesPerTick, uint32_t idleTicks);
+Tickless_Compensation Tickless_compensate (uint32_t currentCycles, uint32_t cyclesPerTick, uint32_t elapsedCycles);
+
+
+#endif
@@ -0,0 +1,55 @@
+/******************************************************************************
+ * [File Name]:     timer.h
+ *
+ * [Description]:   Software Timers Implementation Header File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _TIMER_H
+#define _TIMER_H
+
+#include <stdint.h>
+#include "JarvisOS_kernel.h"
+
+#if (SOFTWARE_TIMERS == 1)
+
+typedef enum {
+    TIMER_SUCCESS,
+    ERROR_TIMER_INVALID,
+    ERROR_TIMER_DAEMON
+}Timer_ErrorCode;
+
+/* Timer modes */
+#define TIMER_ONE_SHOT          0           /* Stops after its first expiry */
+#define TIMER_AUTO_RELOAD       1           /* Expires every period until stopped */
+
+typedef struct xTIMER{
+    struct xTIMER   *next;                  /* Next timer to expire in the active list */
+    uint32_t        expiry;                 /* Tick of the next expiry */
+    uint32_t        period;                 /* In ticks */
+    uint8_t         mode;
+    uint8_t         active;
+    void            (*callback)(struct xTIMER *timer);
+    void            *argument;              /* Left to the application, e.g. for the callback */
+}xTIMER;
+
+/* Definition of Timer Handles */
+typedef xTIMER       TimerHandle_t;
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+uint8_t TimerCreate (TimerHandle_t *timer, uint32_t period, uint8_t mode,
+                     void(*callback)(TimerHandle_t *timer), void *argument);
+void TimerStart (TimerHandle_t *timer);
+void TimerStop (TimerHandle_t *timer);
+void TimerReset (TimerHandle_t *timer);
+uint8_t TimerChangePeriod (TimerHandle_t *timer, uint32_t period);
+uint8_t TimerIsActive (TimerHandle_t *timer);
+
+#endif
+
+#endif
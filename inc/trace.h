@@ -0,0 +1,101 @@
+/******************************************************************************
+ * [File Name]:     trace.h
+ *
+ * [Description]:   Kernel Event Trace Buffer Header File. With TRACE_ENABLE set
+ *                  to 1 the kernel records its scheduling and object events in
+ *                  g_Trace; with 0 every hook compiles to nothing.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdint.h>
+#include "JarvisOS_CONFIG.h"
+#include "JarvisOS_port.h"
+
+/* Kernel events, decoded by tools/jarvis_trace2json.py */
+typedef enum {
+    TRACE_EVENT_SWITCH = 1,                 /* thread starts running, arg: its priority */
+    TRACE_EVENT_CREATE,                     /* thread created, arg: its priority */
+    TRACE_EVENT_TERMINATE,                  /* thread ended */
+    TRACE_EVENT_SUSPEND,                    /* thread suspends itself, arg: ticks (saturated) */
+    TRACE_EVENT_BLOCK,                      /* thread blocked, arg: slot of the caller */
+    TRACE_EVENT_RESUME,                     /* thread resumed, arg: slot of the caller */
+    TRACE_EVENT_SEM_PEND,                   /* arg: semaphore id */
+    TRACE_EVENT_SEM_POST,                   /* arg: semaphore id */
+    TRACE_EVENT_QUEUE_SEND,                 /* arg: queue id */
+    TRACE_EVENT_QUEUE_RECEIVE,              /* arg: queue id */
+    TRACE_EVENT_ISR_ENTER,                  /* arg: exception number */
+    TRACE_EVENT_ISR_EXIT                    /* arg: exception number */
+}Trace_Event;
+
+/* Exception numbers of the kernel interrupts */
+#define TRACE_ISR_SYSTICK       15
+
+#define TRACE_MAGIC             0x4352544A  /* "JTRC" */
+#define TRACE_VERSION           2
+
+/* One record, 12 bytes. thread is the TCB slot, NUM_OF_THREADS is stateIdle.
+ * sequence is written last: a record is only valid while it holds its ring
+ * position plus one, so one claimed but not yet filled is told apart */
+typedef struct{
+    uint32_t            timestamp;          /* PORT_TIMESTAMP() */
+    uint8_t             event;              /* Trace_Event */
+    uint8_t             thread;
+    uint16_t            arg;
+    uint32_t            sequence;
+}Trace_Entry;
+
+/* Everything the host tool needs, dumped as one block of memory */
+typedef struct{
+    uint32_t            magic;
+    uint16_t            version;
+    uint16_t            recordSize;
+    uint32_t            clockHz;            /* Timestamp frequency */
+    uint32_t            length;             /* Records in the ring */
+    volatile uint32_t   head;               /* Records written since reset, the ring keeps the last length */
+    uint16_t            threads;            /* Thread name slots */
+    uint16_t            nameLength;
+    uint8_t             names[NUM_OF_THREADS+1][THREAD_ID_MAX_LENGTH];
+    Trace_Entry         records[TRACE_BUFFER_SIZE];
+}Trace_Buffer;
+
+#if (TRACE_ENABLE == 1)
+
+#if ((TRACE_BUFFER_SIZE) & ((TRACE_BUFFER_SIZE) - 1)) != 0
+#error "Jarvis-OS: TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+extern Trace_Buffer g_Trace;
+
+/* Objects are told apart by the low half of their address */
+#define TRACE_OBJECT(object)                ((uint16_t)(uintptr_t)(object))
+
+#define TRACE_EVENT(event, slot, arg)       Trace_Record((event), (slot), (uint16_t)(arg))
+#define TRACE_THREAD_NAME(slot, name)       Trace_ThreadName((slot), (name))
+#define TRACE_ISR_ENTER(number)             Trace_Record(TRACE_EVENT_ISR_ENTER, Trace_CurrentSlot(), (number))
+#define TRACE_ISR_EXIT(number)              Trace_Record(TRACE_EVENT_ISR_EXIT, Trace_CurrentSlot(), (number))
+
+
+/*******************************************************************************
+ *                          Public Functions Prototypes.
+ ******************************************************************************/
+void Trace_Record (uint8_t event, uint8_t slot, uint16_t arg);
+void Trace_ThreadName (uint8_t slot, const uint8_t *name);
+uint8_t Trace_CurrentSlot (void);
+void Trace_Clear (void);
+
+#else
+
+#define TRACE_OBJECT(object)                0
+#define TRACE_EVENT(event, slot, arg)
+#define TRACE_THREAD_NAME(slot, name)
+#define TRACE_ISR_ENTER(number)
+#define TRACE_ISR_EXIT(number)
+
+#endif
+
+#endif
@@ -0,0 +1,399 @@
+/******************************************************************************
+ * [File Name]:     JarvisOS_port_posix.c
+ *
+ * [Description]:   POSIX Host Port Source File. Runs the unchanged kernel as a
+ *                  Linux process, replacing JarvisOS_port.asm and SysTick.c:
+ *                  - Threads are ucontext contexts on their own native stacks.
+ *                  - SIGALRM from an interval timer is the SysTick interrupt,
+ *                    it runs the kernel's SysTick_Handler, masking it is
+ *                    disabling interrupts. With
+ *                    PORT_POSIX_TICK_CPU, SIGPROF from a CPU time timer.
+ *                  - A requested context switch (PendSV) happens as soon as no
+ *                    critical section or tick handler is active.
+ *                  - With TICKLESS_IDLE, SysTick_sleep doesn't wait: the kernel
+ *                    time jumps straight to the next wake-up (virtual clock).
+ *                  Build with -DJARVIS_PORT_POSIX.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#if defined(JARVIS_PORT_POSIX)
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include "JarvisOS_kernel.h"
+
+#if (PORT_POSIX_TICK_CPU == 1)
+#define PORT_TICK_TIMER         ITIMER_PROF
+#define PORT_TICK_SIGNAL        SIGPROF
+#else
+#define PORT_TICK_TIMER         ITIMER_REAL
+#define PORT_TICK_SIGNAL        SIGALRM
+#endif
+
+typedef struct{
+    ucontext_t      context;
+    void            *owner;                     /* TCB the context belongs to, NULL if unused */
+    void            *stack;                     /* Native stack, kept when the TCB is reused */
+    void            (*entry)(void);
+    void            (*exit)(void);
+}PortContext;
+
+
+/*******************************************************************************
+ *                          Global Variables
+ ******************************************************************************/
+/* One context per TCB, stateIdle included */
+static PortContext g_PortContexts[NUM_OF_THREADS+1];
+
+static sigset_t g_PortTickSignal;
+
+/* Interrupts disabled by PORT_DISABLE_INTERRUPTS */
+static volatile sig_atomic_t g_PortMasked = 0;
+
+/* Running inside the tick handler */
+static volatile sig_atomic_t g_PortInIsr = 0;
+
+/* Context switch requested (PendSV pending) */
+static volatile sig_atomic_t g_PortSwitchPending = 0;
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     portContextOf
+ *
+ * [Description]:       Returns the context stored at a thread's stack pointer
+ *                      by Port_InitStack.
+ *
+ * [Arguments]:         TCB *thread
+ * [Return]:            PortContext *
+ *
+ *****************************************************************************/
+static PortContext *portContextOf (TCB *thread)
+{
+    return *(PortContext **)(void *)thread->stackPtr;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     portThreadStart
+ *
+ * [Description]:       First function of every context. Enters the thread with
+ *                      interrupts enabled, and exits it if the thread returns.
+ *
+ * [Arguments]:         int slot
+ * [Return]:            void
+ *
+ *****************************************************************************/
+static void portThreadStart (int slot)
+{
+    g_PortInIsr = 0;
+    g_PortMasked = 0;
+    sigprocmask(SIG_UNBLOCK, &g_PortTickSignal, NULL);
+
+    g_PortContexts[slot].entry();
+    g_PortContexts[slot].exit();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     portSwitch
+ *
+ * [Description]:       PendSV_Handler equivalent. Lets the kernel pick the next
+ *                      thread and swaps to it. Must be called with the tick
+ *                      signal blocked; returns when this thread runs again.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+static void portSwitch (void)
+{
+    sig_atomic_t inIsr = g_PortInIsr;                       /* Per context, restored when it resumes */
+    TCB *previous = g_curr_running_thread;
+
+    g_PortSwitchPending = 0;
+
+    LoadNextThread();
+
+    if (g_curr_running_thread != previous)
+        swapcontext(&portContextOf(previous)->context, &portContextOf(g_curr_running_thread)->context);
+
+    g_PortInIsr = inIsr;
+    g_PortMasked = 1;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     portTickHandler
+ *
+ * [Description]:       Tick signal handler, runs SysTick_Handler and the context
+ *                      switch it requests.
+ *
+ * [Arguments]:         int signal
+ * [Return]:            void
+ *
+ *****************************************************************************/
+static void portTickHandler (int signal)
+{
+    (void)signal;
+
+    g_PortInIsr = 1;
+    SysTick_Handler();
+    g_PortInIsr = 0;
+
+    if (g_PortSwitchPending)
+    {
+        g_PortMasked = 1;                                   /* The handler already blocks the signal */
+        portSwitch();
+        g_PortMasked = 0;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Port_DisableInterrupts
+ *
+ * [Description]:       Blocks the tick signal.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Port_DisableInterrupts (void)
+{
+    sigprocmask(SIG_BLOCK, &g_PortTickSignal, NULL);
+    g_PortMasked = 1;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Port_EnableInterrupts
+ *
+ * [Description]:       Carries out a pending context switch, then unblocks the
+ *                      tick signal. Inside the tick handler the signal stays
+ *                      blocked until the handler returns.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Port_EnableInterrupts (void)
+{
+    if (g_PortInIsr)
+    {
+        g_PortMasked = 0;
+        return;
+    }
+
+    while (g_PortSwitchPending)
+        portSwitch();
+
+    g_PortMasked = 0;
+    sigprocmask(SIG_UNBLOCK, &g_PortTickSignal, NULL);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Port_TriggerContextSwitch
+ *
+ * [Description]:       Pends a context switch, done right away when called from
+ *                      a thread outside any critical section.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Port_TriggerContextSwitch (void)
+{
+    g_PortSwitchPending = 1;
+
+    if (!g_PortInIsr && !g_PortMasked)
+    {
+        Port_DisableInterrupts();
+        Port_EnableInterrupts();
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Port_InitStack
+ *
+ * [Description]:       Prepares the context a thread starts from. The native
+ *                      stack of the owner TCB is allocated once and reused
+ *                      whenever the TCB is recycled. The kernel stack only
+ *                      stores the context pointer, at the returned address.
+ *
+ * [Arguments]:         void *owner, int32_t *top, void(*Thread)(void), void(*Exit)(void)
+ * [Return]:            int32_t *, initial stack pointer
+ *
+ *****************************************************************************/
+int32_t *Port_InitStack (void *owner, int32_t *top, void(*Thread)(void), void(*Exit)(void))
+{
+    PortContext *context = NULL;
+    int32_t *stackPtr;
+    int slot;
+
+    for (slot = 0 ; slot < NUM_OF_THREADS+1 ; slot++)      /* The TCB's own context, else a free one */
+    {
+        if (g_PortContexts[slot].owner == owner)
+        {
+            context = &g_PortContexts[slot];
+            break;
+        }
+        if (context == NULL && g_PortContexts[slot].owner == NULL)
+            context = &g_PortContexts[slot];
+    }
+
+    if (context == NULL)
+        abort();                                            /* More TCBs than NUM_OF_THREADS+1 */
+
+    slot = (int)(context - g_PortContexts);
+
+    if (context->stack == NULL)
+        context->stack = malloc(PORT_POSIX_STACK_SIZE);
+    if (context->stack == NULL)
+        abort();
+
+    context->owner = owner;
+    context->entry = Thread;
+    context->exit = Exit;
+
+    getcontext(&context->context);
+    context->context.uc_stack.ss_sp = context->stack;
+    context->context.uc_stack.ss_size = PORT_POSIX_STACK_SIZE;
+    context->context.uc_link = NULL;
+    sigemptyset(&context->context.uc_sigmask);
+    makecontext(&context->context, (void (*)(void))portThreadStart, 1, slot);
+
+    stackPtr = top - (sizeof(context) + sizeof(int32_t) - 1) / sizeof(int32_t);
+    *(PortContext **)(void *)stackPtr = context;            /* top is 8-byte aligned */
+
+    return stackPtr;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Port_TimestampInit
+ *
+ * [Description]:       Nothing to start, the host monotonic clock always runs.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Port_TimestampInit (void)
+{
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Port_Timestamp
+ *
+ * [Description]:       Host monotonic clock in microseconds, wrapping at 32 bits
+ *                      like the DWT cycle counter.
+ *
+ * [Arguments]:         void
+ * [Return]:            uint32_t
+ *
+ *****************************************************************************/
+uint32_t Port_Timestamp (void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     SysTick_init
+ *
+ * [Description]:       Starts a PORT_POSIX_TICK_US interval timer delivering
+ *                      the tick signal to portTickHandler. The signal stays
+ *                      blocked until Scheduler_init has entered the first
+ *                      thread.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void SysTick_init (void)
+{
+    struct sigaction action = {0};
+    struct itimerval timer;
+
+    sigemptyset(&g_PortTickSignal);
+    sigaddset(&g_PortTickSignal, PORT_TICK_SIGNAL);
+    Port_DisableInterrupts();
+
+    action.sa_handler = portTickHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(PORT_TICK_SIGNAL, &action, NULL);
+
+    timer.it_interval.tv_sec = PORT_POSIX_TICK_US / 1000000;
+    timer.it_interval.tv_usec = PORT_POSIX_TICK_US % 1000000;
+    timer.it_value = timer.it_interval;
+    setitimer(PORT_TICK_TIMER, &timer, NULL);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     SysTick_sleep
+ *
+ * [Description]:       Virtual clock: when only stateIdle can run, nothing
+ *                      happens until the next wake-up, so the whole idle period
+ *                      is skipped at once and the tick that releases the thread
+ *                      is left pending, as the Cortex-M port does.
+ *                      Called with the tick signal blocked.
+ *
+ * [Arguments]:         uint32_t idleTicks
+ * [Return]:            uint32_t, ticks to add to the kernel time
+ *
+ *****************************************************************************/
+uint32_t SysTick_sleep (uint32_t idleTicks)
+{
+    if (idleTicks == 0xFFFFFFFF)                            /* Nothing to wake up for, only a signal can help */
+        return 0;
+
+    raise(PORT_TICK_SIGNAL);                                /* Delivered once unblocked, releases the thread */
+    return idleTicks - 1;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Scheduler_init
+ *
+ * [Description]:       Starts the first thread chosen by JARVIS_initKernel.
+ *                      Never returns; the simulation ends when a thread calls
+ *                      exit().
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Scheduler_init (void)
+{
+    Port_DisableInterrupts();
+    setcontext(&portContextOf(g_curr_running_thread)->context);
+}
+
+#endif
@@ -8,6 +8,11 @@
  *******************************************************************************/
 
 #include "JarvisOS_kernel.h"
+#include "registry.h"
+#include "mutex.h"
+#include "msgbuffer.h"
+#include "heap.h"
+#include "trace.h"
 
 
 /*******************************************************************************
@@ -16,317 +21,1799 @@
 /* Declare an array of g_Threads. +1 for stateIdle subroutine */
 static TCB g_Threads[NUM_OF_THREADS+1];
 
-/* Pointer to the current running Thread */
-static TCB *g_curr_running_thread = NULL;
+/* Pointer to the current running Thread, also used by PendSV_Handler @ JarvisOS_port.asm */
+TCB *g_curr_running_thread = NULL;
 
-/* Declaring TCB (g_Threads) Stack */
-static int32_t TCB_Stack[NUM_OF_THREADS+1][STACK_SIZE];
+/* stateIdle stack, every other thread brings its own */
+static int32_t g_IdleStack[IDLE_STACK_SIZE];
+
+/* Unused TCBs, linked through next */
+static TCB *g_FreeThreads = NULL;
+static uint8_t g_ThreadPoolReady = 0;
+
+/* Threads that ended but whose TCB and stack aren't reclaimed yet, linked through next */
+static TCB *g_ZombieThreads = NULL;
 
 /* Global Variable to count SysTick countdown times */
 static volatile uint32_t Jarvis_Ticks = 0;
 
+/* Ready Bitmap, bit[n] is set when the ready list of priority n isn't empty */
+static volatile uint32_t g_ReadyBitmap = 0;
+
+/* Head of each priority circular ready list */
+static TCB *g_ReadyLists[MAX_PRIORITIES];
+
+#if (EDF_SCHEDULING == 1)
+/* Ready threads of priority EDF_PRIORITY, a binary min-heap on their deadline.
+ * Its ready list stays empty, the bitmap bit tells if the heap isn't */
+static TCB *g_EdfHeap[NUM_OF_THREADS];
+static uint8_t g_EdfCount = 0;
+#endif
+
+/* Suspended threads sorted by their wake-up tick, earliest first */
+static TCB *g_DelayList = NULL;
+
+/* Critical section nesting counter, interrupts are only enabled again
+ * when the outermost critical section is left */
+static volatile uint32_t g_critical_nesting = 0;
+
+#if (RUNTIME_STATS == 1)
+/* Time of the whole system, charged with every interval the running thread is */
+static RunStats g_SystemStats;
+
+/* PORT_TIMESTAMP of the last time the running thread was charged */
+static uint32_t g_StatsStamp = 0;
+
+/* Bucket slot closed by the next rotation, and ticks into the current bucket */
+static uint8_t g_StatsBucket = 0;
+static uint32_t g_StatsTicks = 0;
+#endif
+
 
 /*******************************************************************************
  *                              Atomic Functions
  ******************************************************************************/
 void sei (void)
 {
-    __asm("CPSID:");
+    PORT_DISABLE_INTERRUPTS();                              /* Disable Global Interrupts */
+    g_critical_nesting++;
     return;
 }
 
 void cli (void)
 {
-    __asm("CPSIE:");
+    if (g_critical_nesting > 0)
+        g_critical_nesting--;
+
+    if (g_critical_nesting == 0)
+        PORT_ENABLE_INTERRUPTS();                           /* Enable Global Interrupts */
     return;
 }
 
 
+#if (EDF_SCHEDULING == 1)
 /******************************************************************************
  *
- * [Function Name]: nextThreadIndex
+ * [Function Name]: edfHeapPlace
  *
- * [Description]:   Responsible for finding the appropriate next Thread to run
- *                  if it's the highest priority and ready thread.
+ * [Description]:   Stores a thread at a heap position and records it in the
+ *                  thread, so it can be removed without a search.
+ *
+ * [Arguments]:     TCB *thread, uint8_t index
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void edfHeapPlace (TCB *thread, uint8_t index)
+{
+    g_EdfHeap[index] = thread;
+    thread->heapIndex = index;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: edfHeapSift
  *
- * [Arguments]:     TCB *ThreadsPtr
+ * [Description]:   Moves the thread at a heap position up or down until its
+ *                  parent is due no later and its children no earlier.
+ *                  O(log n). Must be called with interrupts disabled.
+ *
+ * [Arguments]:     uint8_t index
  * [Return]:        void
  *
  *****************************************************************************/
-uint8_t nextThreadIndex (TCB *ThreadsPtr)
+static void edfHeapSift (uint8_t index)
 {
-    /* Next Thread to run index, by default, is assigned to the IdleThread */
-    uint8_t Idx,nextIdx=NUM_OF_THREADS;
+    TCB *thread = g_EdfHeap[index];
+    uint8_t child;
 
-    /* Next Thread to run priority, by defauly, is assigned to the lowest priority */
-    uint8_t max = 0;
+    while (index > 0 && (int32_t)(thread->deadline - g_EdfHeap[(index - 1) / 2]->deadline) < 0)
+    {
+        edfHeapPlace(g_EdfHeap[(index - 1) / 2], index);    /* Parent due later, move it down */
+        index = (index - 1) / 2;
+    }
 
-    for (Idx = 0 ; Idx < NUM_OF_THREADS ; Idx++)
+    while ((child = 2 * index + 1) < g_EdfCount)
     {
-        if(ThreadsPtr[Idx].status == READY && ThreadsPtr[Idx].priority > max)
-        {
-            max = ThreadsPtr[Idx].priority;
-            nextIdx = Idx;
-        }
+        if (child + 1 < g_EdfCount && (int32_t)(g_EdfHeap[child + 1]->deadline - g_EdfHeap[child]->deadline) < 0)
+            child++;                                        /* The earlier of the two children */
+
+        if ((int32_t)(g_EdfHeap[child]->deadline - thread->deadline) >= 0)
+            break;
+
+        edfHeapPlace(g_EdfHeap[child], index);              /* Child due earlier, move it up */
+        index = child;
     }
-    return nextIdx;
+
+    edfHeapPlace(thread, index);
 }
 
 
 /******************************************************************************
  *
- * [Function Name]: JARVIS_initKernel
+ * [Function Name]: edfHeapInsert
  *
- * [Description]:   Responsible for Initializing SysTick Timer Hardware and
- *                  Initializing the Round-Robin Scheduler.
+ * [Description]:   Adds a ready thread to the EDF heap. A thread without a
+ *                  declared deadline (e.g. raised to the band by priority
+ *                  inheritance) counts as due now.
+ *                  Must be called with interrupts disabled.
  *
- * [Arguments]:     void
+ * [Arguments]:     TCB *thread
  * [Return]:        void
  *
  *****************************************************************************/
-void JARVIS_initKernel(void)
+static void edfHeapInsert (TCB *thread)
 {
-    uint8_t Idx;
+    if (thread->relativeDeadline == 0)
+        thread->deadline = Jarvis_Ticks;
 
-    /* Call nextThreadIndex to know which Thread will initially run */
-    Idx = nextThreadIndex(g_Threads);
+    edfHeapPlace(thread, g_EdfCount);
+    g_EdfCount++;
+    edfHeapSift(thread->heapIndex);
 
-    g_curr_running_thread = &g_Threads[Idx];
+    g_ReadyBitmap |= (1UL << EDF_PRIORITY);
+}
 
-    /* Assign the running state to the initial thread */
-    g_Threads[Idx].status = RUNNING;
 
-    /* Configure SysTick Timer to Round-Robin Quanta Value (in milliseconds) */
-    SysTick_init();
+/******************************************************************************
+ *
+ * [Function Name]: edfHeapRemove
+ *
+ * [Description]:   Takes a thread out of the EDF heap, the last thread fills
+ *                  its position. Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void edfHeapRemove (TCB *thread)
+{
+    uint8_t index = thread->heapIndex;
 
-    /* Assembly Function @ JarvisOS_port.asm */
-    Scheduler_init();
+    g_EdfCount--;
+
+    if (index != g_EdfCount)
+    {
+        edfHeapPlace(g_EdfHeap[g_EdfCount], index);
+        edfHeapSift(index);
+    }
+
+    if (g_EdfCount == 0)
+        g_ReadyBitmap &= ~(1UL << EDF_PRIORITY);
 }
+#endif
 
 
 /******************************************************************************
  *
- * [Function Name]: checkSuspendedState
+ * [Function Name]: readyListInsert
  *
- * [Description]:   Releases suspended threads if their finished their suspension
- *                  time. This function is triggered every QUANTA.
+ * [Description]:   Appends a thread to the tail of its priority ready list
+ *                  and marks that priority as ready in the ready bitmap.
+ *                  Must be called with interrupts disabled.
  *
- * [Arguments]:     void
+ * [Arguments]:     TCB *thread
  * [Return]:        void
  *
  *****************************************************************************/
-void checkSuspendedState (void)
+void readyListInsert (TCB *thread)
 {
-    uint8_t Idx;
+    TCB **head = &g_ReadyLists[thread->priority];
 
-    for (Idx = 0 ; Idx <NUM_OF_THREADS ; Idx++)
+#if (EDF_SCHEDULING == 1)
+    if (thread->priority == EDF_PRIORITY)
     {
-        if (g_Threads[Idx].status == SUSPENDED && g_Threads[Idx].delayTime == Jarvis_Ticks)
-            {
-                g_Threads[Idx].status = READY;
-                g_Threads[Idx].delayTime = 0;
-            }
+        edfHeapInsert(thread);
+        return;
+    }
+#endif
+
+    if (*head == NULL)                                      /* First ready thread of this priority */
+    {
+        thread->next = thread;
+        thread->prev = thread;
+        *head = thread;
+        g_ReadyBitmap |= (1UL << thread->priority);
+    }
+    else                                                    /* Link it behind the current tail */
+    {
+        thread->next = *head;
+        thread->prev = (*head)->prev;
+        (*head)->prev->next = thread;
+        (*head)->prev = thread;
     }
-    Jarvis_Ticks++;
-    return;
 }
 
+
 /******************************************************************************
  *
- * [Function Name]: LoadNextThread
+ * [Function Name]: readyListRemove
  *
- * [Description]:   Assembly subroutine called from JarvisOS_port.asm responsible
- *                  for loading the next appropriate thread into ARM processor.
+ * [Description]:   Unlinks a thread from its priority ready list and clears
+ *                  the priority bit when the list becomes empty.
+ *                  Must be called with interrupts disabled.
  *
- * [Arguments]:     void
+ * [Arguments]:     TCB *thread
  * [Return]:        void
  *
  *****************************************************************************/
-void LoadNextThread(void)
+void readyListRemove (TCB *thread)
 {
-    uint8_t Idx;
-    checkSuspendedState ();                                 /* Release suspended tasks first before choosing the next thread to run */
+    TCB **head = &g_ReadyLists[thread->priority];
 
-    Idx = nextThreadIndex(g_Threads);
+#if (EDF_SCHEDULING == 1)
+    if (thread->priority == EDF_PRIORITY)
+    {
+        edfHeapRemove(thread);
+        return;
+    }
+#endif
 
-    g_curr_running_thread = &g_Threads[Idx];
+    if (thread->next == thread)                             /* Last ready thread of this priority */
+    {
+        *head = NULL;
+        g_ReadyBitmap &= ~(1UL << thread->priority);
+    }
+    else
+    {
+        thread->prev->next = thread->next;
+        thread->next->prev = thread->prev;
 
-    if(g_Threads[NUM_OF_THREADS].status == RUNNING)           /* If the idleThread was running before this thread, return it to ready state */
-        g_Threads[NUM_OF_THREADS].status = READY;
+        if (*head == thread)
+            *head = thread->next;
+    }
+    thread->next = NULL;
+    thread->prev = NULL;
+}
 
-    g_Threads[Idx].status = RUNNING;                          /* Assign the next thread to run to the running state */
 
-    return;
+/******************************************************************************
+ *
+ * [Function Name]: delayListInsert
+ *
+ * [Description]:   Inserts a suspended thread into the delay list, ordered by
+ *                  its absolute wake-up tick (delayTime). Threads with the same
+ *                  wake-up tick keep their suspension order.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void delayListInsert (TCB *thread)
+{
+    TCB *prev = NULL;
+    TCB *node = g_DelayList;
+
+    /* Skip every thread that wakes up before or together with this one */
+    while (node != NULL && TICK_REACHED(thread->delayTime, node->delayTime))
+    {
+        prev = node;
+        node = node->next;
+    }
+
+    thread->prev = prev;
+    thread->next = node;
+
+    if (node != NULL)
+        node->prev = thread;
+
+    if (prev != NULL)
+        prev->next = thread;
+    else
+        g_DelayList = thread;
 }
 
+
 /******************************************************************************
  *
- * [Function Name]:     JARVIS_initStack
+ * [Function Name]: delayListRemove
  *
- * [Description]:       Responsible for creating the stack of each thread.
- *                      & assigning stack pointer to the top of the exception stack area
+ * [Description]:   Unlinks a thread from the delay list, does nothing if the
+ *                  thread isn't in it. Must be called with interrupts disabled.
  *
- * [Arguments]:         uint32_t Idx
- * [Return]:            void
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
  *
  *****************************************************************************/
-void JARVIS_initStack (uint8_t Idx) {
+void delayListRemove (TCB *thread)
+{
+    if (thread->prev == NULL && g_DelayList != thread)      /* Not linked, e.g. pending without a timeout */
+        return;
 
-    g_Threads[Idx].stackPtr = &TCB_Stack[Idx][STACK_SIZE-16]; /* Make the Thread stack pointer points to the Stack Frame section in the thread's stack */
-    TCB_Stack[Idx][STACK_SIZE-1] = 0x1000000;               /* Assign Thread to execute in Thumb mode */
+    if (thread->prev != NULL)
+        thread->prev->next = thread->next;
+    else
+        g_DelayList = thread->next;
+
+    if (thread->next != NULL)
+        thread->next->prev = thread->prev;
+
+    thread->next = NULL;
+    thread->prev = NULL;
 }
 
 
 /******************************************************************************
  *
- * [Function Name]:     ThreadCreate
+ * [Function Name]: waitListInit
  *
- * [Description]:       API Function that's responsible for creating a new thread
+ * [Description]:   Initializes an empty kernel object wait list.
+ *
+ * [Arguments]:     WaitList *list
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void waitListInit (WaitList *list)
+{
+    list->head = NULL;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: waitListInsert
  *
- * [Arguments]:         void(*Thread)(void), uint8_t a_priority
- * [Return]:            uint8_t
+ * [Description]:   Inserts a thread into a wait list behind every waiter of
+ *                  the same or higher priority, so the head is always the
+ *                  highest priority, longest waiting thread.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     WaitList *list, TCB *thread
+ * [Return]:        void
  *
  *****************************************************************************/
-void ThreadCreate(uint8_t *idPtr, void(*Thread)(void), uint8_t a_priority)
+void waitListInsert (WaitList *list, TCB *thread)
 {
-    cli();                                                  /* Disable Global Interrupt bit */
+    TCB *prev = NULL;
+    TCB *node = list->head;
 
-    static uint8_t Idx = 0;
+    while (node != NULL && node->priority >= thread->priority)
+    {
+        prev = node;
+        node = node->eventNext;
+    }
 
-    JARVIS_initStack(Idx);                                  /* Initialize Thread Stack */
+    thread->eventPrev = prev;
+    thread->eventNext = node;
+    thread->eventList = list;
 
-    TCB_Stack[Idx][STACK_SIZE-2] = (int32_t)(Thread);       /* Thread PC <- Thread Address */
+    if (node != NULL)
+        node->eventPrev = thread;
 
-    g_Threads[Idx].priority = a_priority;                     /* Assign Thread Priority */
+    if (prev != NULL)
+        prev->eventNext = thread;
+    else
+        list->head = thread;
+}
 
-    g_Threads[Idx].status = READY;                            /* Thread is initialized in Ready state */
 
-    strcpy(g_Threads[Idx].ThreadID,idPtr);                    /* Assign Thread ID */
+/******************************************************************************
+ *
+ * [Function Name]: waitListRemove
+ *
+ * [Description]:   Unlinks a thread from the wait list it's pending on.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void waitListRemove (TCB *thread)
+{
+    if (thread->eventList == NULL)
+        return;
 
-    Idx++;
+    if (thread->eventPrev != NULL)
+        thread->eventPrev->eventNext = thread->eventNext;
+    else
+        thread->eventList->head = thread->eventNext;
 
-    if (Idx == NUM_OF_THREADS)                              /* Create IdleThread if we reached maximum number of allowed threads */
-        Generate_stateIdle (Idx);
+    if (thread->eventNext != NULL)
+        thread->eventNext->eventPrev = thread->eventPrev;
 
-    sei();                                                  /* Enable Global Interrupt bit */
+    thread->eventNext = NULL;
+    thread->eventPrev = NULL;
+    thread->eventList = NULL;
 }
 
 
 /******************************************************************************
  *
- * [Function Name]:     Generate_stateIdle
+ * [Function Name]: waitOnList
  *
- * [Description]:       Subroutine responsible for creating a wait state task (Wait Task)
- *                      to run when all other threads are suspended.
+ * [Description]:   Pends the running thread on a kernel object wait list for
+ *                  at most timeout ticks (WAIT_FOREVER for no limit) and
+ *                  switches to another thread. Returns once the thread is
+ *                  woken by wakeFromList or its timeout expires.
+ *                  Must be called inside exactly one critical section (sei),
+ *                  which is left for the switch and entered again on return.
  *
- * [Arguments]:         uint8_t Idx
- * [Return]:            void
+ * [Arguments]:     WaitList *list, uint32_t timeout
+ * [Return]:        uint8_t, WAIT_SUCCESS or WAIT_TIMEOUT
  *
  *****************************************************************************/
-void Generate_stateIdle (uint8_t Idx)
+uint8_t waitOnList (WaitList *list, uint32_t timeout)
 {
-    JARVIS_initStack(Idx);                                  /* Create stack for IdleThread */
-    TCB_Stack[Idx][STACK_SIZE-2] = (int32_t)(stateIdle);    /* Make the PC initially point to IdleThread address */
-    g_Threads[Idx].priority = 0;                              /* Assign in to Kernel's lowest priority */
-    g_Threads[Idx].status = READY;                            /* Initialize it as ready */
+    TCB *thread = g_curr_running_thread;
 
-    return;
+    readyListRemove(thread);
+    thread->status = PENDING;
+    thread->waitResult = WAIT_TIMEOUT;                      /* Overwritten by wakeFromList */
+    waitListInsert(list, thread);
+
+    if (timeout != WAIT_FOREVER)
+    {
+        thread->delayTime = Jarvis_Ticks + timeout;
+        delayListInsert(thread);
+    }
+
+    triggerContextSwitch();
+
+    cli();                                                  /* PendSV_Handler switches away here */
+    sei();
+
+    return thread->waitResult;
 }
 
 
 /******************************************************************************
  *
- * [Function Name]:     stateIdle
+ * [Function Name]: wakeFromList
  *
- * [Description]:       Waiting state when all tasks are suspended / blocked.
+ * [Description]:   Wakes the highest priority thread pending on a wait list,
+ *                  hands it a data word and cancels its timeout. A context
+ *                  switch is requested if it outranks the running thread.
+ *                  Must be called with interrupts disabled. ISR safe.
  *
- * [Arguments]:         void
- * [Return]:            void
+ * [Arguments]:     WaitList *list, uint32_t data
+ * [Return]:        TCB *, Woken thread or NULL if nobody was waiting
  *
  *****************************************************************************/
-void stateIdle (void)
+TCB *wakeFromList (WaitList *list, uint32_t data)
 {
-    while (1) {}                                            /* Keep waiting until a physical thread is ready to run */
+    TCB *thread = list->head;
+
+    if (thread == NULL)
+        return NULL;
+
+    wakeThread(thread, data);
+
+    return thread;
 }
 
 
 /******************************************************************************
  *
- * [Function Name]:     Thread_Suspend
+ * [Function Name]: wakeThread
  *
- * [Description]:       API Function responsible for terminating a specific thread
- *                      by triggering SysTick Handler to switch to a new thread.
+ * [Description]:   Same as wakeFromList for a given pending thread, for objects
+ *                  that pick their waiters by other means than priority.
+ *                  Must be called with interrupts disabled. ISR safe.
  *
- * [Arguments]:         uint32_t port_DELAY
- * [Return]:            void
+ * [Arguments]:     TCB *thread, uint32_t data
+ * [Return]:        void
  *
  *****************************************************************************/
-void Thread_Suspend (uint32_t port_DELAY)
+void wakeThread (TCB *thread, uint32_t data)
 {
-    uint8_t Idx;
+    waitListRemove(thread);
 
-    if (port_DELAY == 0)                                    /* if port_DELAY time is zero, do nothing and return */
-        return;
+    delayListRemove(thread);                                /* Cancel its timeout, if any */
 
-    for (Idx = 0; Idx<NUM_OF_THREADS ; Idx++)               /* Keep looping on g_Threads until it finds the Thread who called it */
-    {
-        if (g_Threads[Idx].status == RUNNING)
-        {
-            g_Threads[Idx].status = SUSPENDED;
+    thread->eventData = data;
+    thread->waitResult = WAIT_SUCCESS;
+    thread->status = READY;
+    readyListInsert(thread);
 
-            g_Threads[Idx].delayTime = Jarvis_Ticks + port_DELAY;
-            break;
-        }
-    }
-    ACCESS_REG(SysTick,STCURRENT) = 0;
-    ACCESS_REG(SysTick,INTCTRL) = 0x04000000;               /* Trigger SysTick_Handler found @ JarvisOS_port.asm */
+    if (threadOutranks(thread))
+        triggerContextSwitch();
 }
 
 
 /******************************************************************************
  *
- * [Function Name]:     Thread_Block
+ * [Function Name]: threadSetPriority
  *
- * [Description]:       API Function responsible for Blocking a thread from executing
- *                      till it's resumed
+ * [Description]:   Changes the effective priority of a thread and moves it to
+ *                  its new place in the ready list or in the wait list it's
+ *                  pending on. Must be called with interrupts disabled.
  *
- * [Arguments]:         uint8_t *idPtr
- * [Return]:            void
+ * [Arguments]:     TCB *thread, uint8_t priority
+ * [Return]:        void
  *
  *****************************************************************************/
-void Thread_Block (uint8_t *idPtr)
+void threadSetPriority (TCB *thread, uint8_t priority)
 {
-    uint8_t Idx;
-    for (Idx = 0 ; Idx < NUM_OF_THREADS ; Idx++)            /* Keep looping on g_Threads until it finds the thread required to be blocked */
+    WaitList *list;
+
+    if (thread->status == READY || thread->status == RUNNING)
     {
-        if(strcmp(idPtr,g_Threads[Idx].ThreadID) == 0)
-        {
-            g_Threads[Idx].status = BLOCKED;
-            break;
-        }
+        readyListRemove(thread);
+        thread->priority = priority;
+        readyListInsert(thread);
+    }
+    else if (thread->status == PENDING && thread->eventList != NULL)
+    {
+        list = thread->eventList;
+        waitListRemove(thread);
+        thread->priority = priority;
+        waitListInsert(list, thread);
     }
+    else
+        thread->priority = priority;
 }
 
+
 /******************************************************************************
  *
- * [Function Name]:     Thread_Resume
+ * [Function Name]: nextThread
  *
- * [Description]:       API Function responsible for continue a blocked thread and get
- *                      it back to ready state again.
+ * [Description]:   Responsible for finding the appropriate next Thread to run
+ *                  in constant time. The highest ready priority is found by a
+ *                  single CLZ on the ready bitmap, and the thread at the head
+ *                  of that priority list is chosen.
  *
- * [Arguments]:         uint8_t *idPtr
- * [Return]:            void
+ * [Arguments]:     void
+ * [Return]:        TCB *
+ *
+ *****************************************************************************/
+TCB *nextThread (void)
+{
+    /* stateIdle is always ready at priority 0, so the bitmap is never empty */
+    uint8_t priority = PORT_HIGHEST_BIT(g_ReadyBitmap);
+
+#if (EDF_SCHEDULING == 1)
+    if (priority == EDF_PRIORITY)
+        return g_EdfHeap[0];                                /* Earliest deadline */
+#endif
+
+    return g_ReadyLists[priority];
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: threadOutranks
+ *
+ * [Description]:   Tells whether a thread that just became ready should
+ *                  preempt the running one: a higher priority, or inside the
+ *                  EDF band an earlier deadline.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        uint8_t, 1 if it should run now
+ *
+ *****************************************************************************/
+uint8_t threadOutranks (TCB *thread)
+{
+    if (thread->priority != g_curr_running_thread->priority)
+        return thread->priority > g_curr_running_thread->priority;
+
+#if (EDF_SCHEDULING == 1)
+    if (thread->priority == EDF_PRIORITY)
+        return (int32_t)(thread->deadline - g_curr_running_thread->deadline) < 0;
+#endif
+
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: triggerContextSwitch
+ *
+ * [Description]:   Requests the scheduler to run by pending PendSV_Handler.
+ *                  The switch happens once no other ISR is running and
+ *                  interrupts are enabled, the SysTick time base is untouched.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void triggerContextSwitch (void)
+{
+    PORT_TRIGGER_SWITCH();                                  /* Trigger PendSV_Handler found @ JarvisOS_port.asm */
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: JARVIS_initKernel
+ *
+ * [Description]:   Responsible for creating stateIdle, Initializing SysTick
+ *                  Timer Hardware and Initializing the Round-Robin Scheduler.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void JARVIS_initKernel(void)
+{
+#if (TRACE_ENABLE == 1) || (RUNTIME_STATS == 1)
+    Port_TimestampInit();                                   /* Start the trace / run time base */
+#endif
+
+    /* stateIdle keeps the ready bitmap from ever being empty */
+    Generate_stateIdle();
+
+    /* Call nextThread to know which Thread will initially run */
+    g_curr_running_thread = nextThread();
+
+    /* Assign the running state to the initial thread */
+    g_curr_running_thread->status = RUNNING;
+
+    /* Configure SysTick Timer to Round-Robin Quanta Value (in milliseconds) */
+    SysTick_init();
+
+#if (RUNTIME_STATS == 1)
+    g_StatsStamp = PORT_TIMESTAMP();                        /* The first thread is charged from here */
+#endif
+
+    /* Assembly Function @ JarvisOS_port.asm */
+    Scheduler_init();
+}
+
+
+#if (RUNTIME_STATS == 1)
+/******************************************************************************
+ *
+ * [Function Name]: statsCharge
+ *
+ * [Description]:   Charges the time since the last accounting point to the
+ *                  running thread and to the system. Interrupts interrupting a
+ *                  thread are charged to it. Must be called with interrupts
+ *                  disabled, at least every 2^32 timestamp units.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void statsCharge (void)
+{
+    uint32_t now = PORT_TIMESTAMP();
+    uint32_t elapsed = now - g_StatsStamp;                  /* Wrap safe */
+
+    g_StatsStamp = now;
+
+    RunStats_Charge(&g_curr_running_thread->runStats, elapsed);
+    RunStats_Charge(&g_SystemStats, elapsed);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: statsRotate
+ *
+ * [Description]:   Closes the current bucket of every TCB and of the system,
+ *                  sliding the window by one bucket. Called every
+ *                  RUNTIME_STATS_BUCKET_TICKS ticks.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
  *
  *****************************************************************************/
-void Thread_Resume (uint8_t *idPtr)
+static void statsRotate (void)
 {
     uint8_t Idx;
-    for (Idx = 0 ; Idx < NUM_OF_THREADS ; Idx++)
-    {
-        if(strcmp(idPtr,g_Threads[Idx].ThreadID) == 0)        /* Keep looping on g_Threads until it finds the thread required to be resumed */
+
+    statsCharge();
+
+    for (Idx = 0 ; Idx < NUM_OF_THREADS+1 ; Idx++)          /* Free TCBs too, they're reset when reused */
+        RunStats_Rotate(&g_Threads[Idx].runStats, g_StatsBucket);
+
+    RunStats_Rotate(&g_SystemStats, g_StatsBucket);
+
+    g_StatsBucket = (g_StatsBucket + 1) % RUNTIME_STATS_BUCKETS;
+    g_StatsTicks = 0;
+}
+
+
+#if (TICKLESS_IDLE == 1)
+/******************************************************************************
+ *
+ * [Function Name]: statsSkipTicks
+ *
+ * [Description]:   Accounts for ticks skipped by a tickless sleep. The time
+ *                  since the last accounting point is charged to the running
+ *                  thread, spread over the buckets those ticks cover, and the
+ *                  buckets are rotated as checkSuspendedState would have done.
+ *                  Ticks older than the window only reach the first bucket,
+ *                  which leaves the window anyway, so the loop stays bounded.
+ *
+ * [Arguments]:     uint32_t ticks
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void statsSkipTicks (uint32_t ticks)
+{
+    uint32_t now, elapsed, step, share;
+    uint32_t windowTicks = (RUNTIME_STATS_BUCKETS + 1) * RUNTIME_STATS_BUCKET_TICKS;
+    uint32_t older = 0;
+
+    if (ticks == 0)
+        return;
+
+    now = PORT_TIMESTAMP();
+    elapsed = now - g_StatsStamp;
+    g_StatsStamp = now;
+
+    if (ticks > windowTicks)
+        older = ticks - windowTicks;
+
+    while (ticks > 0)
+    {
+        step = RUNTIME_STATS_BUCKET_TICKS - g_StatsTicks;
+        if (step > ticks - older)
+            step = ticks - older;
+        step += older;
+        older = 0;
+
+        share = (uint32_t)(((uint64_t)elapsed * step) / ticks);  /* The last step takes the rounding rest */
+        elapsed -= share;
+        ticks -= step;
+
+        RunStats_Charge(&g_curr_running_thread->runStats, share);
+        RunStats_Charge(&g_SystemStats, share);
+
+        g_StatsTicks += step;
+        if (g_StatsTicks >= RUNTIME_STATS_BUCKET_TICKS)
+            statsRotate();
+    }
+}
+#endif
+#endif
+
+
+/******************************************************************************
+ *
+ * [Function Name]: JARVIS_GetTicks
+ *
+ * [Description]:   API Function that returns the kernel time, in ticks since
+ *                  JARVIS_initKernel. Wraps around, compare with TICK_REACHED.
+ *
+ * [Arguments]:     void
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+uint32_t JARVIS_GetTicks (void)
+{
+    return Jarvis_Ticks;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: checkSuspendedState
+ *
+ * [Description]:   Advances the kernel time and releases suspended threads that
+ *                  finished their suspension time. This function is triggered
+ *                  every QUANTA by SysTick_Handler. Threads pending on a kernel
+ *                  object with a timeout are released too. Only the
+ *                  head of the delay list is checked, so the cost depends on
+ *                  the number of threads released, not on the sleeping ones.
+ *                  The running thread spends one tick of its slice; once the
+ *                  slice is over it gets a new one and goes behind the other
+ *                  ready threads of its priority (Weighted Round-Robin). A
+ *                  thread that blocks or is preempted keeps what is left of
+ *                  its slice for its next turn.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void checkSuspendedState (void)
+{
+    TCB *thread = g_curr_running_thread;
+
+    Jarvis_Ticks++;
+
+#if (RUNTIME_STATS == 1)
+    if (++g_StatsTicks >= RUNTIME_STATS_BUCKET_TICKS)
+        statsRotate();
+#endif
+
+    if (thread->status == RUNNING && --thread->sliceLeft == 0)
+    {
+        thread->sliceLeft = thread->sliceWeight * TIME_SLICE_TICKS;
+
+        if (g_ReadyLists[thread->priority] == thread)       /* Rotate the circular ready list, thread becomes its tail */
+            g_ReadyLists[thread->priority] = thread->next;
+    }
+
+    while (g_DelayList != NULL && TICK_REACHED(Jarvis_Ticks, g_DelayList->delayTime))
+    {
+        thread = g_DelayList;
+        delayListRemove(thread);
+
+        if (thread->status == PENDING)                      /* Timed out while pending on a kernel object */
+            waitListRemove(thread);
+
+        thread->status = READY;
+        thread->delayTime = 0;
+        readyListInsert(thread);
+    }
+    return;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: SysTick_Handler
+ *
+ * [Description]:   Kernel tick, shared by every port. Advances the kernel time,
+ *                  releases the suspended threads that are due and requests a
+ *                  context switch. The switch itself is deferred to the port
+ *                  (PendSV_Handler @ JarvisOS_port.asm on the Cortex-M).
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void SysTick_Handler (void)
+{
+    TRACE_ISR_ENTER(TRACE_ISR_SYSTICK);
+
+    sei();
+    checkSuspendedState();
+    cli();
+
+    triggerContextSwitch();
+
+    TRACE_ISR_EXIT(TRACE_ISR_SYSTICK);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: LoadNextThread
+ *
+ * [Description]:   Assembly subroutine called from PendSV_Handler @ JarvisOS_port.asm
+ *                  responsible for loading the next appropriate thread into ARM processor.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void LoadNextThread(void)
+{
+#if (RUNTIME_STATS == 1)
+    TCB *previous = g_curr_running_thread;
+
+    statsCharge();                                          /* Close the outgoing thread's run */
+#endif
+
+#if (STACK_OVERFLOW_CHECK == 1)
+    if (g_curr_running_thread->stackPtr < g_curr_running_thread->stackBase ||
+        g_curr_running_thread->stackBase[0] != STACK_FILL_PATTERN)  /* Guard word overwritten or SP below the stack */
+        StackOverflowHook(g_curr_running_thread);
+#endif
+
+    if (g_curr_running_thread->status == RUNNING)           /* If the previous thread is still runnable, return it to ready state */
+        g_curr_running_thread->status = READY;
+
+    g_curr_running_thread = nextThread();
+
+    g_curr_running_thread->status = RUNNING;                /* Assign the next thread to run to the running state */
+
+#if (RUNTIME_STATS == 1)
+    if (g_curr_running_thread != previous)
+    {
+        g_curr_running_thread->runStats.switches++;
+        g_SystemStats.switches++;
+    }
+#endif
+
+    TRACE_EVENT(TRACE_EVENT_SWITCH, g_curr_running_thread->slot, g_curr_running_thread->priority);
+
+    return;
+}
+
+/******************************************************************************
+ *
+ * [Function Name]:     JARVIS_initStack
+ *
+ * [Description]:       Responsible for creating the stack of each thread.
+ *                      Paints the whole stack with STACK_FILL_PATTERN, has the port
+ *                      build the initial frame at its 8-byte aligned top & assigns
+ *                      the stack pointer to the frame. The thread returns to
+ *                      Thread_Exit, so returning from the thread function exits it.
+ *
+ * [Arguments]:         TCB *thread, int32_t *stack, uint32_t stackSize, void(*Thread)(void)
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void JARVIS_initStack (TCB *thread, int32_t *stack, uint32_t stackSize, void(*Thread)(void))
+{
+    int32_t *top;
+    uint32_t Idx;
+
+    for (Idx = 0 ; Idx < stackSize ; Idx++)                 /* Paint the stack to measure its usage later */
+        stack[Idx] = STACK_FILL_PATTERN;
+
+    top = (int32_t *)((uintptr_t)(stack + stackSize) & ~(uintptr_t)7);
+
+    thread->stackBase = stack;
+    thread->stackSize = stackSize;
+    thread->stackPtr = Port_InitStack(thread, top, Thread, Thread_Exit); /* Build the frame the port starts the thread from */
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     threadCreate
+ *
+ * [Description]:       Takes a TCB from the free pool and starts a thread on the
+ *                      given stack. When the pool is empty, threads that ended
+ *                      are reclaimed first. Can be called before or after
+ *                      JARVIS_initKernel; a new thread more urgent than the
+ *                      caller runs immediately.
+ *
+ * [Arguments]:         const uint8_t *idPtr, void(*Thread)(void), uint8_t a_priority,
+ *                      int32_t *stack, uint32_t stackSize, uint8_t heapStack
+ * [Return]:            TCB *, NULL if every TCB is taken
+ *
+ *****************************************************************************/
+static TCB *threadCreate(const uint8_t *idPtr, void(*Thread)(void), uint8_t a_priority,
+                         int32_t *stack, uint32_t stackSize, uint8_t heapStack)
+{
+    uint8_t Idx;
+    TCB *thread;
+
+    sei();                                                  /* Disable Global Interrupt bit */
+
+    if (g_ThreadPoolReady == 0)                             /* First call, fill the pool. g_Threads[NUM_OF_THREADS] is stateIdle's */
+    {
+        for (Idx = 0 ; Idx < NUM_OF_THREADS ; Idx++)
+        {
+            g_Threads[Idx].status = TERMINATED;
+            g_Threads[Idx].slot = Idx;
+            g_Threads[Idx].next = g_FreeThreads;
+            g_FreeThreads = &g_Threads[Idx];
+        }
+        g_ThreadPoolReady = 1;
+    }
+
+    if (g_FreeThreads == NULL)
+        reapThreads();
+
+    if (g_FreeThreads == NULL)                              /* Every TCB is taken */
+    {
+        cli();
+        return NULL;
+    }
+
+    if (a_priority >= MAX_PRIORITIES)                       /* Clip the priority to the highest ready list */
+        a_priority = MAX_PRIORITIES - 1;
+
+    thread = g_FreeThreads;
+    g_FreeThreads = thread->next;
+
+    JARVIS_initStack(thread, stack, stackSize, Thread);     /* Initialize Thread Stack */
+
+    thread->priority = a_priority;                          /* Assign Thread Priority */
+    thread->basePriority = a_priority;
+    thread->heapStack = heapStack;
+    thread->sliceWeight = 1;
+    thread->sliceLeft = TIME_SLICE_TICKS;
+    thread->eventList = NULL;                               /* Nothing left over from the TCB's previous thread */
+    thread->mutexesHeld = NULL;
+    thread->blockingMutex = NULL;
+    thread->msgBuffer = NULL;
+    waitListInit(&thread->joinWaiters);
+
+#if (THREAD_NOTIFICATIONS == 1)
+    thread->notifyValue = 0;
+    thread->notifyPending = 0;
+    waitListInit(&thread->notifyWait);
+#endif
+
+#if (RUNTIME_STATS == 1)
+    RunStats_Reset(&thread->runStats);                      /* Don't inherit the previous thread's time */
+#endif
+
+#if (EDF_SCHEDULING == 1)
+    thread->relativeDeadline = 0;                           /* No deadline until Thread_SetDeadline */
+    thread->period = 0;
+    thread->deadlineMisses = 0;
+#endif
+
+    thread->status = READY;                                 /* Thread is initialized in Ready state */
+
+    strncpy(thread->ThreadID, idPtr, THREAD_ID_MAX_LENGTH); /* Assign Thread ID, truncated to fit the TCB */
+
+    TRACE_THREAD_NAME(thread->slot, thread->ThreadID);
+    TRACE_EVENT(TRACE_EVENT_CREATE, thread->slot, thread->priority);
+
+#if (THREAD_REGISTRY == 1)
+    Registry_Add(thread);                                   /* Make it reachable by name */
+#endif
+
+    readyListInsert(thread);                                /* Make it visible to the scheduler */
+
+    cli();                                                  /* Enable Global Interrupt bit */
+
+    if (g_curr_running_thread != NULL && threadOutranks(thread))
+        triggerContextSwitch();                             /* Created at run time by a less urgent thread */
+
+    return thread;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     ThreadCreateStatic
+ *
+ * [Description]:       API Function that's responsible for creating a new thread
+ *                      on a caller supplied stack of stackSize words. The stack
+ *                      can be reused once the thread has ended (Thread_Join).
+ *
+ * [Arguments]:         const uint8_t *idPtr, void(*Thread)(void), uint8_t a_priority,
+ *                      int32_t *stack, uint32_t stackSize
+ * [Return]:            ThreadHandle_t, NULL if every TCB is taken or the stack
+ *                      is smaller than STACK_MIN_SIZE
+ *
+ *****************************************************************************/
+ThreadHandle_t ThreadCreateStatic(const uint8_t *idPtr, void(*Thread)(void), uint8_t a_priority,
+                                  int32_t *stack, uint32_t stackSize)
+{
+    if (stack == NULL || stackSize < STACK_MIN_SIZE)
+        return NULL;
+
+    return threadCreate(idPtr, Thread, a_priority, stack, stackSize, 0);
+}
+
+
+#if (DYNAMIC_ALLOCATION == 1)
+/******************************************************************************
+ *
+ * [Function Name]:     ThreadCreate
+ *
+ * [Description]:       API Function that's responsible for creating a new thread
+ *                      with a stack of stackSize words taken from the kernel heap.
+ *                      A stackSize of 0 selects STACK_SIZE. The stack goes back
+ *                      to the heap once the thread has ended.
+ *
+ * [Arguments]:         const uint8_t *idPtr, void(*Thread)(void), uint8_t a_priority,
+ *                      uint32_t stackSize
+ * [Return]:            ThreadHandle_t, NULL if no TCB or heap memory is left
+ *
+ *****************************************************************************/
+ThreadHandle_t ThreadCreate(const uint8_t *idPtr, void(*Thread)(void), uint8_t a_priority, uint32_t stackSize)
+{
+    int32_t *stack;
+    ThreadHandle_t thread;
+
+    if (stackSize == 0)
+        stackSize = STACK_SIZE;
+
+    if (stackSize < STACK_MIN_SIZE)
+        return NULL;
+
+    stack = (int32_t *) HeapAlloc(stackSize * sizeof(int32_t));
+
+    if (stack == NULL)
+        return NULL;
+
+    thread = threadCreate(idPtr, Thread, a_priority, stack, stackSize, 1);
+
+    if (thread == NULL)
+        HeapFree(stack);                                    /* Don't leak the stack */
+
+    return thread;
+}
+#endif
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_GetStackHighWaterMark
+ *
+ * [Description]:       API Function that reports the least amount of free stack
+ *                      a thread has had since it was created, by counting the
+ *                      words at the bottom of its stack still holding the fill
+ *                      pattern.
+ *
+ * [Arguments]:         ThreadHandle_t thread
+ * [Return]:            uint32_t, unused stack words
+ *
+ *****************************************************************************/
+uint32_t Thread_GetStackHighWaterMark (ThreadHandle_t thread)
+{
+    uint32_t unused = 0;
+
+    if (thread == NULL)
+        return 0;
+
+    while (unused < thread->stackSize && thread->stackBase[unused] == STACK_FILL_PATTERN)
+        unused++;
+
+    return unused;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_GetCurrent
+ *
+ * [Description]:       API Function that returns the handle of the calling thread
+ *
+ * [Arguments]:         void
+ * [Return]:            ThreadHandle_t
+ *
+ *****************************************************************************/
+ThreadHandle_t Thread_GetCurrent (void)
+{
+    return g_curr_running_thread;
+}
+
+
+#if (RUNTIME_STATS == 1)
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_GetRunStats
+ *
+ * [Description]:       API Function that takes a snapshot of the processor time
+ *                      used by each thread alive, and by the whole system when
+ *                      system isn't NULL. Loads are over the sliding window:
+ *                      the last RUNTIME_STATS_BUCKETS buckets plus the current
+ *                      one. stateIdle's time is reported as the system idle time.
+ *
+ * [Arguments]:         Thread_RunStats *threads, uint32_t maxThreads,
+ *                      System_RunStats *system
+ * [Return]:            uint32_t, entries written to threads
+ *
+ *****************************************************************************/
+uint32_t Thread_GetRunStats (Thread_RunStats *threads, uint32_t maxThreads, System_RunStats *system)
+{
+    uint32_t count = 0;
+    uint32_t window;
+    uint8_t Idx;
+    TCB *thread;
+
+    sei();
+
+    if (g_curr_running_thread != NULL)                      /* Bring the running thread up to now */
+        statsCharge();
+
+    window = RunStats_WindowTime(&g_SystemStats);
+
+    for (Idx = 0 ; Idx < NUM_OF_THREADS && count < maxThreads ; Idx++)
+    {
+        thread = &g_Threads[Idx];
+
+        if (thread->status == TERMINATED)                   /* Free or ended */
+            continue;
+
+        threads[count].thread = thread;
+        threads[count].runTime = thread->runStats.total;
+        threads[count].switches = thread->runStats.switches;
+        threads[count].cpuLoad = RunStats_Percent(RunStats_WindowTime(&thread->runStats), window);
+        count++;
+    }
+
+    if (system != NULL)
+    {
+        thread = &g_Threads[NUM_OF_THREADS];                /* stateIdle */
+
+        system->upTime = g_SystemStats.total;
+        system->idleTime = thread->runStats.total;
+        system->switches = g_SystemStats.switches;
+        system->windowTime = window;
+        system->cpuLoad = (window == 0) ? 0 :
+                          RUNSTATS_PERCENT_FULL - RunStats_Percent(RunStats_WindowTime(&thread->runStats), window);
+    }
+
+    cli();
+
+    return count;
+}
+#endif
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Generate_stateIdle
+ *
+ * [Description]:       Subroutine responsible for creating a wait state task (Wait Task)
+ *                      to run when all other threads are suspended. It lives in
+ *                      the last TCB, outside the thread pool.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Generate_stateIdle (void)
+{
+    TCB *idle = &g_Threads[NUM_OF_THREADS];
+
+    JARVIS_initStack(idle, g_IdleStack, IDLE_STACK_SIZE, stateIdle); /* Create stack for IdleThread, PC points to stateIdle */
+    idle->priority = 0;                                     /* Assign in to Kernel's lowest priority */
+    idle->basePriority = 0;
+    idle->status = READY;                                   /* Initialize it as ready */
+    idle->slot = NUM_OF_THREADS;
+    idle->sliceWeight = 1;
+    idle->sliceLeft = TIME_SLICE_TICKS;
+    TRACE_THREAD_NAME(idle->slot, (const uint8_t *)"stateIdle");
+    readyListInsert(idle);                                  /* stateIdle never leaves its ready list */
+
+    return;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     reapThreads
+ *
+ * [Description]:       Reclaims the threads that ended: returns their stack to
+ *                      the heap if it came from there, and their TCB to the
+ *                      pool. A thread that is still switching away from its own
+ *                      Thread_Exit is left for the next call.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void reapThreads (void)
+{
+    TCB **link;
+    TCB *thread;
+
+    sei();
+
+    link = &g_ZombieThreads;
+    while (*link != NULL)
+    {
+        thread = *link;
+
+        if (thread == g_curr_running_thread)                /* Still running on its stack */
+        {
+            link = &thread->next;
+            continue;
+        }
+
+        *link = thread->next;
+
+#if (DYNAMIC_ALLOCATION == 1)
+        if (thread->heapStack)
+            HeapFree(thread->stackBase);
+#endif
+
+        thread->next = g_FreeThreads;
+        g_FreeThreads = thread;
+    }
+
+    cli();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     stateIdle
+ *
+ * [Description]:       Waiting state when all tasks are suspended / blocked.
+ *                      Reclaims the resources of the threads that ended.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void stateIdle (void)
+{
+    while (1)                                               /* Keep waiting until a physical thread is ready to run */
+    {
+        if (g_ZombieThreads != NULL)
+            reapThreads();
+
+#if (TICKLESS_IDLE == 1)
+        suppressTicksAndSleep();
+#endif
+    }
+}
+
+
+#if (TICKLESS_IDLE == 1)
+/******************************************************************************
+ *
+ * [Function Name]:     suppressTicksAndSleep
+ *
+ * [Description]:       Called by stateIdle. When stateIdle is the only ready thread,
+ *                      takes the earliest wake-up from the delay list and sleeps
+ *                      until then with the periodic tick stopped. Jarvis_Ticks and
+ *                      the run time buckets are advanced by the ticks that were
+ *                      skipped.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void suppressTicksAndSleep (void)
+{
+    uint32_t idleTicks = 0xFFFFFFFF;
+    uint32_t skipped;
+
+    sei();
+
+    if (g_ReadyBitmap == 1UL && g_ReadyLists[0]->next == g_ReadyLists[0])
+    {
+        if (g_DelayList != NULL)                            /* Tick boundaries until the earliest suspended thread is released */
         {
-            g_Threads[Idx].status = READY;
-            break;
+            if (TICK_REACHED(Jarvis_Ticks, g_DelayList->delayTime))
+                idleTicks = 1;
+            else
+                idleTicks = g_DelayList->delayTime - Jarvis_Ticks;
+        }
+
+        if (idleTicks > 1)                                  /* Nothing to gain when the next tick is already due */
+        {
+            skipped = SysTick_sleep(idleTicks);
+            Jarvis_Ticks += skipped;
+
+#if (RUNTIME_STATS == 1)
+            statsSkipTicks(skipped);                        /* Keep the run time window sliding */
+#endif
         }
     }
+
+    cli();
+}
+#endif
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_Suspend
+ *
+ * [Description]:       API Function responsible for suspending the calling thread
+ *                      for port_DELAY ticks and switching to a new thread.
+ *
+ * [Arguments]:         uint32_t port_DELAY
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Thread_Suspend (uint32_t port_DELAY)
+{
+    if (port_DELAY == 0)                                    /* if port_DELAY time is zero, do nothing and return */
+        return;
+
+    sei();
+
+    TRACE_EVENT(TRACE_EVENT_SUSPEND, g_curr_running_thread->slot, (port_DELAY > 0xFFFF) ? 0xFFFF : port_DELAY);
+
+    readyListRemove(g_curr_running_thread);                 /* The calling thread is the running one */
+    g_curr_running_thread->status = SUSPENDED;
+    g_curr_running_thread->delayTime = Jarvis_Ticks + port_DELAY;
+    delayListInsert(g_curr_running_thread);
+
+    cli();
+
+    triggerContextSwitch();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_Block
+ *
+ * [Description]:       API Function responsible for Blocking a thread from executing
+ *                      till it's resumed
+ *
+ * [Arguments]:         ThreadHandle_t thread
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Thread_Block (ThreadHandle_t thread)
+{
+    if (thread == NULL)
+        return;
+
+    sei();
+
+    if (thread->status == TERMINATED)
+    {
+        cli();
+        return;
+    }
+
+    if (thread->status == READY || thread->status == RUNNING)
+        readyListRemove(thread);
+    else if (thread->status == SUSPENDED)
+        delayListRemove(thread);
+    else if (thread->status == PENDING)                     /* Abort its pend, it reports a timeout once resumed */
+    {
+        waitListRemove(thread);
+        delayListRemove(thread);
+        Mutex_AbortWait(thread);
+    }
+
+    thread->status = BLOCKED;
+
+    TRACE_EVENT(TRACE_EVENT_BLOCK, thread->slot, Trace_CurrentSlot());
+
+    cli();
+
+    if (thread == g_curr_running_thread)                    /* A thread blocking itself gives up the processor */
+        triggerContextSwitch();
+}
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_Resume
+ *
+ * [Description]:       API Function responsible for continue a blocked thread and get
+ *                      it back to ready state again.
+ *
+ * [Arguments]:         ThreadHandle_t thread
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Thread_Resume (ThreadHandle_t thread)
+{
+    if (thread == NULL)
+        return;
+
+    sei();
+
+    if (thread->status == BLOCKED || thread->status == SUSPENDED)
+    {
+        if (thread->status == SUSPENDED)
+            delayListRemove(thread);
+
+        thread->status = READY;
+        readyListInsert(thread);
+
+        TRACE_EVENT(TRACE_EVENT_RESUME, thread->slot, Trace_CurrentSlot());
+    }
+
+    cli();
+
+    if (g_curr_running_thread != NULL && threadOutranks(thread))
+        triggerContextSwitch();                             /* Preempt the caller if it resumed a more urgent thread */
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     threadTerminate
+ *
+ * [Description]:       Takes a thread out of every kernel list, releases the
+ *                      mutexes it holds, the message it's copying and the
+ *                      threads joining it, and queues it for reapThreads.
+ *                      Must be called with interrupts disabled.
+ *
+ * [Arguments]:         TCB *thread
+ * [Return]:            void
+ *
+ *****************************************************************************/
+static void threadTerminate (TCB *thread)
+{
+    if (thread->status == READY || thread->status == RUNNING)
+        readyListRemove(thread);
+    else if (thread->status == SUSPENDED)
+        delayListRemove(thread);
+    else if (thread->status == PENDING)
+    {
+        waitListRemove(thread);
+        delayListRemove(thread);
+        Mutex_AbortWait(thread);
+    }
+
+    thread->status = TERMINATED;
+
+    Mutex_ReleaseAll(thread);                               /* Nobody can unlock them after this */
+    MsgBuffer_AbortCopy(thread);
+
+    TRACE_EVENT(TRACE_EVENT_TERMINATE, thread->slot, 0);
+
+#if (THREAD_REGISTRY == 1)
+    Registry_Remove(thread);
+#endif
+
+    while (wakeFromList(&thread->joinWaiters, 0) != NULL)   /* Every joiner returns THREAD_SUCCESS */
+        ;
+
+    thread->next = g_ZombieThreads;
+    g_ZombieThreads = thread;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_Exit
+ *
+ * [Description]:       API Function that ends the calling thread. Also reached
+ *                      when a thread function returns. Mutexes still held by the
+ *                      thread go to their waiters or become free.
+ *
+ * [Arguments]:         void
+ * [Return]:            void, never returns
+ *
+ *****************************************************************************/
+void Thread_Exit (void)
+{
+    sei();
+
+    threadTerminate(g_curr_running_thread);
+
+    cli();
+
+    triggerContextSwitch();
+
+    while (1);                                              /* PendSV_Handler never comes back here */
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_Delete
+ *
+ * [Description]:       API Function that ends a thread wherever it is: ready,
+ *                      suspended, blocked or pending on a kernel object. Deleting
+ *                      the calling thread (or NULL) is the same as Thread_Exit.
+ *
+ * [Arguments]:         ThreadHandle_t thread
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Thread_Delete (ThreadHandle_t thread)
+{
+    if (thread == NULL || thread == g_curr_running_thread)
+        Thread_Exit();
+
+    if (thread == &g_Threads[NUM_OF_THREADS])               /* stateIdle can't go */
+        return;
+
+    sei();
+
+    if (thread->status != TERMINATED)
+        threadTerminate(thread);
+
+    cli();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_Join
+ *
+ * [Description]:       API Function that waits at most timeout ticks (WAIT_FOREVER
+ *                      for no limit) for a thread to end. A thread's handle is
+ *                      only valid until the thread has ended and its TCB is
+ *                      reused, so join threads you created yourself.
+ *
+ * [Arguments]:         ThreadHandle_t thread, uint32_t timeout
+ * [Return]:            uint8_t, THREAD_SUCCESS, ERROR_THREAD_TIMEOUT or
+ *                      ERROR_THREAD_INVALID when joining itself or NULL
+ *
+ *****************************************************************************/
+uint8_t Thread_Join (ThreadHandle_t thread, uint32_t timeout)
+{
+    uint8_t result = THREAD_SUCCESS;
+
+    if (thread == NULL || thread == g_curr_running_thread)
+        return ERROR_THREAD_INVALID;
+
+    sei();
+
+    if (thread->status != TERMINATED)
+    {
+        if (timeout == 0)
+            result = ERROR_THREAD_TIMEOUT;
+        else if (waitOnList(&thread->joinWaiters, timeout) == WAIT_TIMEOUT)
+            result = ERROR_THREAD_TIMEOUT;
+    }
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_Yield
+ *
+ * [Description]:       API Function responsible for giving up the processor to the
+ *                      next ready thread of the same priority, without waiting for
+ *                      the end of its slice or touching SysTick. The rest of the
+ *                      slice is given up, its next turn starts a full one.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Thread_Yield (void)
+{
+    sei();
+
+    readyListRemove(g_curr_running_thread);                 /* Move the caller to the tail of its ready list */
+    readyListInsert(g_curr_running_thread);
+
+    g_curr_running_thread->sliceLeft = g_curr_running_thread->sliceWeight * TIME_SLICE_TICKS;  /* Its turn is over */
+
+    cli();
+
+    triggerContextSwitch();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_SetTimeSlice
+ *
+ * [Description]:       API Function that sets a thread's slice to weight times
+ *                      TIME_SLICE_TICKS. Ready threads of the same priority
+ *                      share the processor in the ratio of their weights; new
+ *                      threads have a weight of 1. A slice already running is
+ *                      cut short to the new length, never extended.
+ *
+ * [Arguments]:         ThreadHandle_t thread, uint8_t weight
+ * [Return]:            uint8_t, THREAD_SUCCESS, or ERROR_THREAD_INVALID for a 0
+ *                      weight or a NULL thread
+ *
+ *****************************************************************************/
+uint8_t Thread_SetTimeSlice (ThreadHandle_t thread, uint8_t weight)
+{
+    uint32_t slice = (uint32_t)weight * TIME_SLICE_TICKS;
+
+    if (thread == NULL || weight == 0)
+        return ERROR_THREAD_INVALID;
+
+    sei();
+
+    thread->sliceWeight = weight;
+    if (thread->sliceLeft > slice)
+        thread->sliceLeft = slice;
+
+    cli();
+
+    return THREAD_SUCCESS;
+}
+
+
+#if (EDF_SCHEDULING == 1)
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_SetDeadline
+ *
+ * [Description]:       API Function that moves a thread to the EDF band with a
+ *                      relative deadline and a release period, both in ticks.
+ *                      Its first job is released now. Threads in the band run
+ *                      earliest absolute deadline first, below the fixed
+ *                      priorities above EDF_PRIORITY.
+ *
+ * [Arguments]:         ThreadHandle_t thread, uint32_t deadline, uint32_t period
+ * [Return]:            uint8_t, THREAD_SUCCESS, or ERROR_THREAD_INVALID for a 0
+ *                      deadline or one longer than a non-zero period
+ *
+ *****************************************************************************/
+uint8_t Thread_SetDeadline (ThreadHandle_t thread, uint32_t deadline, uint32_t period)
+{
+    uint8_t priority;
+
+    if (thread == NULL || deadline == 0 || (period != 0 && deadline > period))
+        return ERROR_THREAD_INVALID;
+
+    sei();
+
+    if (thread->status == TERMINATED)
+    {
+        cli();
+        return ERROR_THREAD_INVALID;
+    }
+
+    priority = thread->priority;
+    if (priority == thread->basePriority)                   /* Not raised by priority inheritance */
+        priority = EDF_PRIORITY;
+
+    if (thread->status == READY || thread->status == RUNNING)
+        readyListRemove(thread);                            /* Leave the heap before its key changes */
+
+    thread->relativeDeadline = deadline;
+    thread->period = period;
+    thread->release = Jarvis_Ticks;
+    thread->deadline = Jarvis_Ticks + deadline;
+    thread->deadlineMisses = 0;
+    thread->basePriority = EDF_PRIORITY;
+
+    if (thread->status == READY || thread->status == RUNNING)
+    {
+        thread->priority = priority;
+        readyListInsert(thread);
+    }
+    else
+        threadSetPriority(thread, priority);
+
+    cli();
+
+    if (g_curr_running_thread != NULL)
+        triggerContextSwitch();                             /* The band order may have changed */
+
+    return THREAD_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_WaitNextPeriod
+ *
+ * [Description]:       API Function called by a periodic EDF thread when its
+ *                      job is done. Counts a deadline miss if it's late, then
+ *                      suspends the thread until its next release, which gets
+ *                      the next deadline. A job that overran its period starts
+ *                      the next one right away. No effect without a period.
+ *
+ * [Arguments]:         void
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Thread_WaitNextPeriod (void)
+{
+    TCB *thread = g_curr_running_thread;
+
+    if (thread->period == 0)
+        return;
+
+    sei();
+
+    if ((int32_t)(Jarvis_Ticks - thread->deadline) > 0)
+        thread->deadlineMisses++;
+
+    readyListRemove(thread);
+
+    thread->release += thread->period;
+    thread->deadline = thread->release + thread->relativeDeadline;
+
+    if (TICK_REACHED(Jarvis_Ticks, thread->release))        /* Overran, released already */
+        readyListInsert(thread);
+    else
+    {
+        thread->status = SUSPENDED;
+        thread->delayTime = thread->release;
+        delayListInsert(thread);
+    }
+
+    cli();
+
+    triggerContextSwitch();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_GetDeadlineMisses
+ *
+ * [Description]:       API Function that returns how many jobs of an EDF thread
+ *                      completed after their deadline.
+ *
+ * [Arguments]:         ThreadHandle_t thread
+ * [Return]:            uint32_t
+ *
+ *****************************************************************************/
+uint32_t Thread_GetDeadlineMisses (ThreadHandle_t thread)
+{
+    if (thread == NULL)
+        return 0;
+
+    return thread->deadlineMisses;
 }
+#endif
@@ -5,15 +5,17 @@
 			.thumb										;Execute the code in Thumb Mode
 			.ref	g_curr_running_thread				;Extern currPtr from Jarvis-OS-Kernel.c
 			.ref	LoadNextThread
-			.def	SysTick_Handler						;Define SysTick_Handler Function (Like C Prototypes)
+			.def	PendSV_Handler						;Define PendSV_Handler Function (Like C Prototypes)
 			.def	Scheduler_init
 
 currThread:	.word	g_curr_running_thread
 
-; [Function Name]:	SysTick_Handler
-; [Description]:	Function responsible for context switching between threads
+; [Function Name]:	PendSV_Handler
+; [Description]:	Function responsible for context switching between threads.
+;					Runs at the lowest exception priority, after every other ISR
+;					that requested a switch has finished.
 	.align 4
-SysTick_Handler: .asmfunc
+PendSV_Handler: .asmfunc
 	CPSID	I					; Disable Global Interrupts
 	PUSH	{R4-R11}			; Push the rest of Registers int the stack
 	LDR		R0,currThread		; R0 <- Current Thread TCB Address
@@ -40,11 +42,12 @@ Scheduler_init: .asmfunc
 	POP		{R4-R11}			; POP Registers R4~R11 of current thread into Register Bank
 	POP		{R0-R3}				; POP Registers R0~R3 of current thread into Register Bank
 	POP		{R12}				; POP Register R12 of current thread into Register Bank
-	ADD		SP,SP,#4
-	POP		{LR}
-	ADD		SP,SP,#4
+	POP		{LR}				; LR <- Thread_Exit, reached if the thread function returns
+	POP		{R1}				; R1 <- Thread entry point
+	ORR		R1,R1,#1			; The frame holds it without the Thumb bit
+	ADD		SP,SP,#4			; Skip xPSR
 	CPSIE	I					; Enable Global Interrupts
-	BX		LR					; Return
+	BX		R1					; Jump to the thread
 				.endasmfunc
 
 .end
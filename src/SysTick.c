@@ -13,6 +13,7 @@
 #include "SysTick.h"
 #include "JarvisOS_CONFIG.h"
 #include "JarvisOS_kernel.h"
+#include "tickless.h"
 
 
 /******************************************************************************
@@ -31,8 +32,8 @@ void SysTick_init (void)
     ACCESS_REG(SysTick,STCTRL) = 0;
     ACCESS_REG(SysTick,STCURRENT) = 0;
 
-    /* Set SysTick Timer to Have the Least Interrupt Priority */
-    ACCESS_REG(SysTick,SYSPRI3) = (ACCESS_REG(SysTick,SYSPRI3) & 0x07FFFFFF) | (LEAST_PRIORITY);
+    /* Set SysTick Timer and PendSV to Have the Least Interrupt Priority */
+    ACCESS_REG(SysTick,SYSPRI3) = (ACCESS_REG(SysTick,SYSPRI3) & 0x1F1FFFFF) | (LEAST_PRIORITY) | (PENDSV_LEAST_PRIORITY);
 
     /* Load Quanta value to the SysTick Reload Register */
     ACCESS_REG(SysTick,STRELOAD) = (MS_TO_TICKS(QUANTA)) - 1;
@@ -43,3 +44,90 @@ void SysTick_init (void)
      */
     ACCESS_REG(SysTick,STCTRL) |= 0x00000007;
 }
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     SysTick_sleep
+ *
+ * [Description]:       Stops the periodic tick and sleeps (WFI) until the idleTicks-th
+ *                      tick boundary, chaining several reloads when the sleep is
+ *                      longer than the 24-bit counter. An interrupt other than SysTick
+ *                      ends the sleep early. The tick phase is restored afterwards and,
+ *                      if the wake-up boundary was reached, SysTick is left pending so
+ *                      SysTick_Handler releases the waiting thread.
+ *                      Must be called with interrupts disabled.
+ *
+ * [Arguments]:         uint32_t idleTicks
+ * [Return]:            uint32_t, Tick interrupts skipped that the kernel must account for
+ *
+ *****************************************************************************/
+uint32_t SysTick_sleep (uint32_t idleTicks)
+{
+    uint32_t cyclesPerTick = MS_TO_TICKS(QUANTA);
+    uint32_t currentCycles, sleepCycles, remaining, chunk, ctrl;
+    uint8_t interrupted = 0;
+    Tickless_Compensation comp;
+
+    /* Stop counting and read what's left of the current tick */
+    ACCESS_REG(SysTick,STCTRL) &= ~STCTRL_ENABLE;
+    currentCycles = ACCESS_REG(SysTick,STCURRENT);
+
+    if ((ACCESS_REG(SysTick,INTCTRL) & INTCTRL_PENDSTSET) || currentCycles == 0)
+    {
+        ACCESS_REG(SysTick,STCTRL) |= STCTRL_ENABLE;        /* A tick is already due, don't sleep */
+        return 0;
+    }
+
+    sleepCycles = Tickless_sleepCycles(currentCycles, cyclesPerTick, idleTicks);
+    remaining = sleepCycles;
+
+    while (remaining > 1 && !interrupted)
+    {
+        chunk = (remaining > SYSTICK_MAX_RELOAD + 1) ? (SYSTICK_MAX_RELOAD + 1) : remaining;
+
+        ACCESS_REG(SysTick,STRELOAD) = chunk - 1;
+        ACCESS_REG(SysTick,STCURRENT) = 0;                  /* Counter reloads from STRELOAD when enabled */
+        ACCESS_REG(SysTick,STCTRL) |= STCTRL_ENABLE;
+
+        __asm(" WFI");                                      /* Pending interrupts wake the core even while masked */
+
+        ctrl = ACCESS_REG(SysTick,STCTRL);                  /* Reading STCTRL clears the COUNT flag */
+        ACCESS_REG(SysTick,STCTRL) = ctrl & ~STCTRL_ENABLE;
+
+        if (ctrl & STCTRL_COUNT)
+        {
+            remaining -= chunk;
+            ACCESS_REG(SysTick,INTCTRL) = INTCTRL_PENDSTCLR;    /* An intermediate reload isn't a kernel tick */
+
+            if (ACCESS_REG(SysTick,INTCTRL) & INTCTRL_VECPEND)
+                interrupted = 1;                            /* Another interrupt fired in the same period */
+        }
+        else
+        {
+            remaining -= (chunk - 1) - ACCESS_REG(SysTick,STCURRENT);
+            interrupted = 1;
+        }
+    }
+
+    comp = Tickless_compensate(currentCycles, cyclesPerTick, sleepCycles - remaining);
+
+    if (comp.nextTickCycles < 2)                            /* Too close to reload, count it as a whole tick */
+    {
+        comp.nextTickCycles += cyclesPerTick;
+        comp.ticks++;
+    }
+
+    /* Restart the time base in phase with the skipped ticks */
+    ACCESS_REG(SysTick,STRELOAD) = comp.nextTickCycles - 1;
+    ACCESS_REG(SysTick,STCURRENT) = 0;
+    ACCESS_REG(SysTick,STCTRL) |= STCTRL_ENABLE;
+    ACCESS_REG(SysTick,STRELOAD) = cyclesPerTick - 1;       /* Taken on the next reload, following ticks are full quanta */
+
+    if (comp.ticks >= idleTicks)                            /* Wake-up boundary reached, let SysTick_Handler process it */
+    {
+        ACCESS_REG(SysTick,INTCTRL) = INTCTRL_PENDSTSET;
+        return comp.ticks - 1;
+    }
+    return comp.ticks;
+}
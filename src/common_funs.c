@@ -5,15 +5,15 @@
  ******************************************************************************/
 int8_t strcmp(const uint8_t *Str_1, const uint8_t *Str_2)
 {
-    while (*Str_1)
+    while (*Str_1 && *Str_1 == *Str_2)                  /* Stop at the first difference or at the end of both */
     {
-        if (*Str_1 != *Str_2)
-            return -1;
-
         Str_1++;
         Str_2++;
     }
-    return 0;
+
+    if (*Str_1 == *Str_2)
+        return 0;
+    return (*Str_1 < *Str_2) ? -1 : 1;
 }
 void strcpy (uint8_t *destination, const uint8_t *source)
 {
@@ -29,4 +29,33 @@ void strcpy (uint8_t *destination, const uint8_t *source)
         *destination = '\0';
 
         return;
-}
\ No newline at end of file
+}
+void strncpy (uint8_t *destination, const uint8_t *source, uint32_t length)
+{
+    if (destination == NULL || length == 0)
+        return;
+
+    while (*source != '\0' && length > 1)               /* Keep the last byte for the terminator */
+    {
+        *destination = *source;
+        destination++;
+        source++;
+        length--;
+    }
+    *destination = '\0';
+}
+int8_t strncmp (const uint8_t *Str_1, const uint8_t *Str_2, uint32_t length)
+{
+    if (length == 0)
+        return 0;
+
+    while (--length && *Str_1 && *Str_1 == *Str_2)      /* Compare at most length characters */
+    {
+        Str_1++;
+        Str_2++;
+    }
+
+    if (*Str_1 == *Str_2)
+        return 0;
+    return (*Str_1 < *Str_2) ? -1 : 1;
+}
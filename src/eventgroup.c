@@ -0,0 +1,203 @@
+/******************************************************************************
+ * [File Name]:     eventgroup.c
+ *
+ * [Description]:   Event Groups Implementation Source File.
+ *                  A thread waits for any or all of a set of event bits with a
+ *                  single pend. Setting bits wakes every waiter it satisfies in
+ *                  one pass over the wait list, then clears the bits those
+ *                  waiters asked to consume.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "eventgroup.h"
+
+
+/******************************************************************************
+ *
+ * [Function Name]: eventsSatisfied
+ *
+ * [Description]:   Checks a bit pattern against what a waiter waits for.
+ *
+ * [Arguments]:     uint32_t current, const EventGroup_Wait *request
+ * [Return]:        uint8_t, 1 if satisfied
+ *
+ *****************************************************************************/
+static uint8_t eventsSatisfied (uint32_t current, const EventGroup_Wait *request)
+{
+    if (request->options & EVENT_WAIT_ALL)
+        return (current & request->bits) == request->bits;
+
+    return (current & request->bits) != 0;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: EventGroupCreate
+ *
+ * [Description]:   Creates an event group with every bit cleared.
+ *
+ * [Arguments]:     EventGroupHandle_t *group
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void EventGroupCreate (EventGroupHandle_t *group)
+{
+    group->bits = 0;
+    waitListInit(&group->waiters);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: EventGroupSet
+ *
+ * [Description]:   Sets event bits and wakes every waiting thread they satisfy,
+ *                  each receiving the bits as they were when it was satisfied.
+ *                  ISR safe.
+ *
+ * [Arguments]:     EventGroupHandle_t *group, uint32_t bits
+ * [Return]:        uint32_t, Event bits once the woken threads cleared theirs
+ *
+ *****************************************************************************/
+uint32_t EventGroupSet (EventGroupHandle_t *group, uint32_t bits)
+{
+    uint32_t clear = 0;
+    uint32_t result;
+    TCB *thread;
+    TCB *next;
+    EventGroup_Wait *request;
+
+    sei();
+
+    group->bits |= bits;
+
+    for (thread = group->waiters.head ; thread != NULL ; thread = next)
+    {
+        next = thread->eventNext;                           /* Waking unlinks the thread */
+        request = (EventGroup_Wait *) thread->eventBuffer;
+
+        if (eventsSatisfied(group->bits, request))
+        {
+            if (request->options & EVENT_CLEAR_ON_EXIT)
+                clear |= request->bits;                     /* Cleared after the pass, every waiter sees the same bits */
+
+            wakeThread(thread, group->bits);
+        }
+    }
+
+    group->bits &= ~clear;
+    result = group->bits;
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: EventGroupClear
+ *
+ * [Description]:   Clears event bits. ISR safe.
+ *
+ * [Arguments]:     EventGroupHandle_t *group, uint32_t bits
+ * [Return]:        uint32_t, Event bits before they were cleared
+ *
+ *****************************************************************************/
+uint32_t EventGroupClear (EventGroupHandle_t *group, uint32_t bits)
+{
+    uint32_t result;
+
+    sei();
+
+    result = group->bits;
+    group->bits = result & ~bits;
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: EventGroupGet
+ *
+ * [Description]:   Reads the event bits. ISR safe.
+ *
+ * [Arguments]:     EventGroupHandle_t *group
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+uint32_t EventGroupGet (EventGroupHandle_t *group)
+{
+    return group->bits;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: EventGroupWait
+ *
+ * [Description]:   Waits for any (EVENT_WAIT_ANY) or all (EVENT_WAIT_ALL) of
+ *                  the given bits for at most timeout ticks (WAIT_FOREVER for
+ *                  no limit). With EVENT_CLEAR_ON_EXIT the bits waited for are
+ *                  cleared when the wait is satisfied. A timeout of 0 never
+ *                  waits and is ISR safe.
+ *
+ * [Arguments]:     EventGroupHandle_t *group, uint32_t bits, uint8_t options,
+ *                  uint32_t *value, uint32_t timeout
+ * [Return]:        uint8_t, EVENTGROUP_SUCCESS, ERROR_EVENTGROUP_TIMEOUT or
+ *                  ERROR_EVENTGROUP_INVALID when bits is 0. value (if not NULL)
+ *                  receives the event bits that satisfied the wait, or the
+ *                  current ones on a timeout.
+ *
+ *****************************************************************************/
+uint8_t EventGroupWait (EventGroupHandle_t *group, uint32_t bits, uint8_t options,
+                        uint32_t *value, uint32_t timeout)
+{
+    uint8_t result = EVENTGROUP_SUCCESS;
+    uint32_t current;
+    EventGroup_Wait request;
+
+    if (bits == 0)
+        return ERROR_EVENTGROUP_INVALID;
+
+    request.bits = bits;
+    request.options = options;
+
+    sei();
+
+    current = group->bits;
+
+    if (eventsSatisfied(current, &request))
+    {
+        if (options & EVENT_CLEAR_ON_EXIT)
+            group->bits = current & ~bits;
+    }
+
+    else if (timeout == 0)
+        result = ERROR_EVENTGROUP_TIMEOUT;
+
+    else
+    {
+        g_curr_running_thread->eventBuffer = &request;      /* Read by EventGroupSet while we wait */
+
+        if (waitOnList(&group->waiters, timeout) == WAIT_SUCCESS)
+            current = g_curr_running_thread->eventData;     /* Bits handed over by EventGroupSet, already cleared for us */
+        else
+        {
+            result = ERROR_EVENTGROUP_TIMEOUT;
+            current = group->bits;
+        }
+    }
+
+    cli();
+
+    if (value != NULL)
+        *value = current;
+
+    return result;
+}
@@ -0,0 +1,423 @@
+/******************************************************************************
+ * [File Name]:     heap.c
+ *
+ * [Description]:   TLSF (Two-Level Segregated Fit) Kernel Heap Source File.
+ *                  Free blocks are kept in lists indexed by a first level
+ *                  (power of two size range) and a second level (linear split
+ *                  of that range). Two bitmaps tell which lists aren't empty,
+ *                  so allocation and free take a bounded number of steps
+ *                  whatever the heap state. Adjacent free blocks are merged
+ *                  on free.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "heap.h"
+#include "JarvisOS_kernel.h"
+
+#if (DYNAMIC_ALLOCATION == 1)
+
+/* Bit 0 of the block size: the block is free */
+#define HEAP_BLOCK_FREE         ((size_t)1)
+
+typedef struct HeapBlock{
+    struct HeapBlock    *prevPhys;              /* Block just before this one in memory, NULL for the first */
+    size_t              size;                   /* Payload size in bytes | HEAP_BLOCK_FREE */
+    struct HeapBlock    *nextFree;              /* Free list links, overlap the payload of used blocks */
+    struct HeapBlock    *prevFree;
+}HeapBlock;
+
+#define HEAP_HEADER_SIZE        (offsetof(HeapBlock, nextFree))
+#define HEAP_MIN_BLOCK          (sizeof(HeapBlock) - HEAP_HEADER_SIZE)
+
+#define BLOCK_SIZE(block)       ((block)->size & ~HEAP_BLOCK_FREE)
+#define BLOCK_IS_FREE(block)    ((block)->size & HEAP_BLOCK_FREE)
+#define BLOCK_NEXT(block)       ((HeapBlock *)((uint8_t *)(block) + HEAP_HEADER_SIZE + BLOCK_SIZE(block)))
+#define LOWEST_BIT(x)           PORT_HIGHEST_BIT((x) & (0 - (x)))
+
+
+/*******************************************************************************
+ *                          Global Variables
+ ******************************************************************************/
+/* Heap memory, uint64_t keeps it 8 bytes aligned */
+static uint64_t g_HeapPool[HEAP_SIZE / sizeof(uint64_t)];
+
+/* First level bitmap, bit[n] is set when any list of row n isn't empty */
+static uint32_t g_FlBitmap = 0;
+
+/* Second level bitmaps, bit[m] of row n is set when list [n][m] isn't empty */
+static uint32_t g_SlBitmap[HEAP_FL_COUNT];
+
+static HeapBlock *g_FreeLists[HEAP_FL_COUNT][HEAP_SL_COUNT];
+
+static uint8_t g_HeapReady = 0;
+static uint32_t g_HeapTotal = 0;
+static uint32_t g_HeapFree = 0;
+static uint32_t g_HeapMinFree = 0;
+
+
+/******************************************************************************
+ *
+ * [Function Name]: mappingInsert
+ *
+ * [Description]:   Finds the free list a block of the given size belongs to.
+ *
+ * [Arguments]:     size_t size, uint32_t *fl, uint32_t *sl
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void mappingInsert (size_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size < (1 << HEAP_FL_SHIFT))                        /* Small blocks, one list per HEAP_ALIGN step */
+    {
+        *fl = 0;
+        *sl = (uint32_t)(size >> HEAP_ALIGN_LOG2);
+    }
+    else
+    {
+        *fl = PORT_HIGHEST_BIT((uint32_t)size);
+        *sl = (uint32_t)(size >> (*fl - HEAP_SL_LOG2)) ^ (1 << HEAP_SL_LOG2);
+        *fl -= (HEAP_FL_SHIFT - 1);
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: mappingSearch
+ *
+ * [Description]:   Finds the first free list whose every block is at least the
+ *                  given size, by rounding the size up to the next list.
+ *
+ * [Arguments]:     size_t size, uint32_t *fl, uint32_t *sl
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void mappingSearch (size_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size >= (1 << HEAP_FL_SHIFT))
+        size += ((size_t)1 << (PORT_HIGHEST_BIT((uint32_t)size) - HEAP_SL_LOG2)) - 1;
+
+    mappingInsert(size, fl, sl);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: mappingMinSize
+ *
+ * [Description]:   Returns the smallest block size that belongs to a free list,
+ *                  the inverse of mappingInsert. It's also the largest request
+ *                  that mappingSearch still maps to that list.
+ *
+ * [Arguments]:     uint32_t fl, uint32_t sl
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+static uint32_t mappingMinSize (uint32_t fl, uint32_t sl)
+{
+    if (fl == 0)
+        return sl << HEAP_ALIGN_LOG2;
+
+    fl += HEAP_FL_SHIFT - 1;
+
+    return (1UL << fl) + (sl << (fl - HEAP_SL_LOG2));
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: findSuitable
+ *
+ * [Description]:   Returns the head of the first non-empty free list at or above
+ *                  [fl][sl] using the bitmaps, and updates fl and sl to it.
+ *
+ * [Arguments]:     uint32_t *fl, uint32_t *sl
+ * [Return]:        HeapBlock *, NULL if no block is large enough
+ *
+ *****************************************************************************/
+static HeapBlock *findSuitable (uint32_t *fl, uint32_t *sl)
+{
+    uint32_t slMap = g_SlBitmap[*fl] & (uint32_t)(0xFFFFFFFF << *sl);
+    uint32_t flMap;
+
+    if (slMap == 0)                                         /* Nothing in this row, take the next non-empty row */
+    {
+        flMap = g_FlBitmap & (uint32_t)(0xFFFFFFFF << (*fl + 1));
+
+        if (flMap == 0)
+            return NULL;
+
+        *fl = LOWEST_BIT(flMap);
+        slMap = g_SlBitmap[*fl];
+    }
+
+    *sl = LOWEST_BIT(slMap);
+
+    return g_FreeLists[*fl][*sl];
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: freeListInsert
+ *
+ * [Description]:   Pushes a free block to the head of its free list.
+ *
+ * [Arguments]:     HeapBlock *block
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void freeListInsert (HeapBlock *block)
+{
+    uint32_t fl, sl;
+
+    mappingInsert(BLOCK_SIZE(block), &fl, &sl);
+
+    block->prevFree = NULL;
+    block->nextFree = g_FreeLists[fl][sl];
+
+    if (block->nextFree != NULL)
+        block->nextFree->prevFree = block;
+
+    g_FreeLists[fl][sl] = block;
+    g_SlBitmap[fl] |= (1UL << sl);
+    g_FlBitmap |= (1UL << fl);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: freeListRemove
+ *
+ * [Description]:   Unlinks a free block from its free list.
+ *
+ * [Arguments]:     HeapBlock *block
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void freeListRemove (HeapBlock *block)
+{
+    uint32_t fl, sl;
+
+    mappingInsert(BLOCK_SIZE(block), &fl, &sl);
+
+    if (block->prevFree != NULL)
+        block->prevFree->nextFree = block->nextFree;
+    else
+        g_FreeLists[fl][sl] = block->nextFree;
+
+    if (block->nextFree != NULL)
+        block->nextFree->prevFree = block->prevFree;
+
+    if (g_FreeLists[fl][sl] == NULL)
+    {
+        g_SlBitmap[fl] &= ~(1UL << sl);
+
+        if (g_SlBitmap[fl] == 0)
+            g_FlBitmap &= ~(1UL << fl);
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: heapInit
+ *
+ * [Description]:   Turns the whole pool into one free block, followed by a
+ *                  zero sized used block that stops merging at the pool end.
+ *                  The sentinel gets a whole HeapBlock, so it's never accessed
+ *                  past the pool.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void heapInit (void)
+{
+    HeapBlock *first = (HeapBlock *)g_HeapPool;
+    HeapBlock *sentinel;
+
+    first->prevPhys = NULL;
+    first->size = (sizeof(g_HeapPool) - HEAP_HEADER_SIZE - sizeof(HeapBlock)) | HEAP_BLOCK_FREE;
+
+    sentinel = BLOCK_NEXT(first);
+    sentinel->prevPhys = first;
+    sentinel->size = 0;
+
+    freeListInsert(first);
+
+    g_HeapTotal = (uint32_t)BLOCK_SIZE(first);
+    g_HeapFree = g_HeapTotal;
+    g_HeapMinFree = g_HeapTotal;
+    g_HeapReady = 1;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: HeapAlloc
+ *
+ * [Description]:   Allocates size bytes from the kernel heap in bounded time.
+ *                  ISR safe.
+ *
+ * [Arguments]:     size_t size
+ * [Return]:        void *, NULL if there's no free block large enough
+ *
+ *****************************************************************************/
+void *HeapAlloc (size_t size)
+{
+    HeapBlock *block = NULL;
+    HeapBlock *rest;
+    uint32_t fl, sl;
+    size_t adjusted;
+
+    if (size == 0 || size > HEAP_SIZE)
+        return NULL;
+
+    adjusted = (size + HEAP_ALIGN - 1) & ~(size_t)(HEAP_ALIGN - 1);
+
+    if (adjusted < HEAP_MIN_BLOCK)
+        adjusted = HEAP_MIN_BLOCK;
+
+    sei();
+
+    if (!g_HeapReady)
+        heapInit();
+
+    mappingSearch(adjusted, &fl, &sl);
+
+    if (fl < HEAP_FL_COUNT)
+        block = findSuitable(&fl, &sl);
+
+    if (block != NULL)
+    {
+        freeListRemove(block);
+        g_HeapFree -= (uint32_t)BLOCK_SIZE(block);
+
+        if (BLOCK_SIZE(block) >= adjusted + HEAP_HEADER_SIZE + HEAP_MIN_BLOCK)
+        {
+            /* Split off the tail and give it back */
+            rest = (HeapBlock *)((uint8_t *)block + HEAP_HEADER_SIZE + adjusted);
+            rest->prevPhys = block;
+            rest->size = (BLOCK_SIZE(block) - adjusted - HEAP_HEADER_SIZE) | HEAP_BLOCK_FREE;
+            BLOCK_NEXT(rest)->prevPhys = rest;
+
+            block->size = adjusted;
+
+            freeListInsert(rest);
+            g_HeapFree += (uint32_t)BLOCK_SIZE(rest);
+        }
+        else
+            block->size = BLOCK_SIZE(block);                /* Mark it used */
+
+        if (g_HeapFree < g_HeapMinFree)
+            g_HeapMinFree = g_HeapFree;
+    }
+
+    cli();
+
+    return (block != NULL) ? (uint8_t *)block + HEAP_HEADER_SIZE : NULL;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: HeapFree
+ *
+ * [Description]:   Returns a block to the kernel heap, merging it with its free
+ *                  neighbours. NULL is ignored. ISR safe.
+ *
+ * [Arguments]:     void *ptr
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void HeapFree (void *ptr)
+{
+    HeapBlock *block, *neighbour;
+
+    if (ptr == NULL)
+        return;
+
+    block = (HeapBlock *)((uint8_t *)ptr - HEAP_HEADER_SIZE);
+
+    sei();
+
+    block->size |= HEAP_BLOCK_FREE;
+    g_HeapFree += (uint32_t)BLOCK_SIZE(block);
+
+    neighbour = block->prevPhys;
+
+    if (neighbour != NULL && BLOCK_IS_FREE(neighbour))      /* Merge into the previous block */
+    {
+        freeListRemove(neighbour);
+        neighbour->size += HEAP_HEADER_SIZE + BLOCK_SIZE(block);
+        block = neighbour;
+        g_HeapFree += HEAP_HEADER_SIZE;
+    }
+
+    neighbour = BLOCK_NEXT(block);
+
+    if (BLOCK_IS_FREE(neighbour))                           /* Absorb the next block, never the sentinel */
+    {
+        freeListRemove(neighbour);
+        block->size += HEAP_HEADER_SIZE + BLOCK_SIZE(neighbour);
+        g_HeapFree += HEAP_HEADER_SIZE;
+    }
+
+    BLOCK_NEXT(block)->prevPhys = block;
+    freeListInsert(block);
+
+    cli();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: HeapGetStats
+ *
+ * [Description]:   Fills a snapshot of the kernel heap usage. HeapAlloc rounds
+ *                  a request up to the next free list, so the largest block can
+ *                  only serve requests up to the smallest size of its list, and
+ *                  that's what largestFreeBlock reports.
+ *
+ * [Arguments]:     HeapStats_t *stats
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void HeapGetStats (HeapStats_t *stats)
+{
+    HeapBlock *block;
+    uint32_t fl, sl;
+    uint32_t largest = 0;
+    uint32_t allocatable = 0;
+
+    sei();
+
+    if (!g_HeapReady)
+        heapInit();
+
+    if (g_FlBitmap != 0)                                    /* The largest block is in the highest non-empty list */
+    {
+        fl = PORT_HIGHEST_BIT(g_FlBitmap);
+        sl = PORT_HIGHEST_BIT(g_SlBitmap[fl]);
+
+        for (block = g_FreeLists[fl][sl] ; block != NULL ; block = block->nextFree)
+        {
+            if (BLOCK_SIZE(block) > largest)
+                largest = (uint32_t)BLOCK_SIZE(block);
+        }
+
+        allocatable = mappingMinSize(fl, sl);
+    }
+
+    stats->totalBytes = g_HeapTotal;
+    stats->freeBytes = g_HeapFree;
+    stats->largestFreeBlock = allocatable;
+    stats->fragmentation = (g_HeapFree != 0) ? 100 - (largest * 100) / g_HeapFree : 0;
+    stats->highWaterMark = g_HeapTotal - g_HeapMinFree;
+
+    cli();
+}
+
+#endif
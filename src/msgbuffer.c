@@ -0,0 +1,509 @@
+/******************************************************************************
+ * [File Name]:     msgbuffer.c
+ *
+ * [Description]:   Variable Length Message Buffer Implementation Source File.
+ *                  Messages are stored back-to-back in one caller supplied ring,
+ *                  each one behind a MSGBUF_HEADER_SIZE bytes header holding its
+ *                  length and its state. Only the bookkeeping runs with
+ *                  interrupts disabled: a sender reserves its space, copies
+ *                  with interrupts enabled, then marks its message ready; a
+ *                  receiver claims the oldest ready message the same way. Each
+ *                  message changes state on its own, so a copy that is
+ *                  preempted only holds back its own message, and the
+ *                  interrupt latency doesn't grow with the message length.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "msgbuffer.h"
+
+/* Message states, kept in the last header byte */
+#define MSG_WRITING             0           /* Reserved, its sender is copying it in */
+#define MSG_READY               1           /* Complete, waiting for a receiver */
+#define MSG_READING             2           /* Claimed, its receiver is copying it out */
+#define MSG_DONE                3           /* Received or dropped, freed once it reaches the head */
+
+/* Pending send, kept on the waiting thread's stack */
+typedef struct{
+    uint32_t        length;
+}MsgBuffer_Request;
+
+
+/******************************************************************************
+ *
+ * [Function Name]: ringWrite
+ *
+ * [Description]:   Copies bytes into the ring from a given offset, wrapping at
+ *                  the end of the storage.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint32_t offset, const uint8_t *source,
+ *                  uint32_t count
+ * [Return]:        uint32_t, Offset after the last byte written
+ *
+ *****************************************************************************/
+static uint32_t ringWrite (MsgBufferHandle_t *buffer, uint32_t offset, const uint8_t *source, uint32_t count)
+{
+    while (count--)
+    {
+        buffer->Data_Ptr[offset] = *source++;
+
+        if (++offset == buffer->capacity)
+            offset = 0;
+    }
+    return offset;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: ringRead
+ *
+ * [Description]:   Copies bytes out of the ring from a given offset, wrapping
+ *                  at the end of the storage.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint32_t offset, uint8_t *destination,
+ *                  uint32_t count
+ * [Return]:        uint32_t, Offset after the last byte read
+ *
+ *****************************************************************************/
+static uint32_t ringRead (MsgBufferHandle_t *buffer, uint32_t offset, uint8_t *destination, uint32_t count)
+{
+    while (count--)
+    {
+        *destination++ = buffer->Data_Ptr[offset];
+
+        if (++offset == buffer->capacity)
+            offset = 0;
+    }
+    return offset;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: messageLength
+ *
+ * [Description]:   Returns the length of the message whose header is at offset.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint32_t offset
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+static uint32_t messageLength (MsgBufferHandle_t *buffer, uint32_t offset)
+{
+    uint8_t header[MSGBUF_HEADER_SIZE];
+
+    ringRead(buffer, offset, header, MSGBUF_HEADER_SIZE);
+
+    return (uint32_t)header[0] | ((uint32_t)header[1] << 8);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: stateOffset
+ *
+ * [Description]:   Returns the offset of the state byte of the header at offset.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint32_t offset
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+static uint32_t stateOffset (MsgBufferHandle_t *buffer, uint32_t offset)
+{
+    return (offset + MSGBUF_HEADER_SIZE - 1) % buffer->capacity;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: messageFind
+ *
+ * [Description]:   Returns the header offset of the oldest ready message,
+ *                  skipping the ones still being copied in or out. Only the
+ *                  bytes past 'scanned' are searched. The caller checks a
+ *                  message is ready. Must be called with interrupts disabled.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+static uint32_t messageFind (MsgBufferHandle_t *buffer)
+{
+    uint32_t offset = (buffer->head + buffer->scanned) % buffer->capacity;
+
+    while (buffer->Data_Ptr[stateOffset(buffer, offset)] != MSG_READY)
+    {
+        buffer->scanned += MSGBUF_HEADER_SIZE + messageLength(buffer, offset);
+        offset = (buffer->head + buffer->scanned) % buffer->capacity;
+    }
+
+    return offset;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: copyOwner
+ *
+ * [Description]:   Records the message a thread is copying in or out, so it can
+ *                  be released if the thread ends mid-copy. A NULL buffer
+ *                  clears it. thread is NULL before the kernel starts.
+ *
+ * [Arguments]:     TCB *thread, MsgBufferHandle_t *buffer, uint32_t offset
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void copyOwner (TCB *thread, MsgBufferHandle_t *buffer, uint32_t offset)
+{
+    if (thread == NULL)
+        return;
+
+    thread->msgBuffer = buffer;
+    thread->msgOffset = offset;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: messageReserve
+ *
+ * [Description]:   Reserves space for one message and its header at the tail,
+ *                  on behalf of the thread that will copy it in, if any. The
+ *                  caller checks there's enough free space.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint32_t length, TCB *sender
+ * [Return]:        uint32_t, Offset of the reserved space
+ *
+ *****************************************************************************/
+static uint32_t messageReserve (MsgBufferHandle_t *buffer, uint32_t length, TCB *sender)
+{
+    uint8_t header[MSGBUF_HEADER_SIZE];
+    uint32_t offset = buffer->tail;
+
+    header[0] = (uint8_t)(length);
+    header[1] = (uint8_t)(length >> 8);
+    header[2] = MSG_WRITING;
+
+    buffer->tail = ringWrite(buffer, offset, header, MSGBUF_HEADER_SIZE);
+    buffer->tail = (buffer->tail + length) % buffer->capacity;
+    buffer->used += MSGBUF_HEADER_SIZE + length;
+
+    copyOwner(sender, buffer, offset);                      /* Dropped by MsgBuffer_AbortCopy if the sender ends first */
+
+    return offset;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: messageReady
+ *
+ * [Description]:   Makes a message available to the receivers and wakes one.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint32_t offset
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void messageReady (MsgBufferHandle_t *buffer, uint32_t offset)
+{
+    uint32_t distance = (offset + buffer->capacity - buffer->head) % buffer->capacity;
+
+    buffer->Data_Ptr[stateOffset(buffer, offset)] = MSG_READY;
+    buffer->ready++;
+
+    if (distance < buffer->scanned)                         /* Behind the search start, move it back */
+        buffer->scanned = distance;
+
+    wakeFromList(&buffer->receiveWaiters, 0);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: serveSenders
+ *
+ * [Description]:   Reserves space, in order, for the waiting senders whose
+ *                  messages now fit in the ring and makes them ready to copy
+ *                  them in. Must be called with interrupts disabled.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void serveSenders (MsgBufferHandle_t *buffer)
+{
+    TCB *sender;
+    MsgBuffer_Request *request;
+
+    while ((sender = buffer->sendWaiters.head) != NULL)
+    {
+        request = (MsgBuffer_Request *)sender->eventBuffer;
+
+        if (request->length + MSGBUF_HEADER_SIZE > buffer->capacity - buffer->used)
+            break;
+
+        wakeFromList(&buffer->sendWaiters, messageReserve(buffer, request->length, sender));
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: messageFree
+ *
+ * [Description]:   Marks a message done and frees every done message at the
+ *                  head of the ring, then serves the waiting senders.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint32_t offset
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void messageFree (MsgBufferHandle_t *buffer, uint32_t offset)
+{
+    uint32_t size;
+
+    buffer->Data_Ptr[stateOffset(buffer, offset)] = MSG_DONE;
+
+    while (buffer->used > 0 && buffer->Data_Ptr[stateOffset(buffer, buffer->head)] == MSG_DONE)
+    {
+        size = MSGBUF_HEADER_SIZE + messageLength(buffer, buffer->head);
+
+        buffer->head = (buffer->head + size) % buffer->capacity;
+        buffer->used -= size;
+        buffer->scanned = (buffer->scanned > size) ? buffer->scanned - size : 0;
+    }
+
+    serveSenders(buffer);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MsgBuffer_AbortCopy
+ *
+ * [Description]:   Called by the kernel when a thread ends. A message it was
+ *                  copying in is dropped, one it was copying out becomes ready
+ *                  again for the next receiver.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void MsgBuffer_AbortCopy (TCB *thread)
+{
+    MsgBufferHandle_t *buffer = thread->msgBuffer;
+
+    if (buffer == NULL)
+        return;
+
+    thread->msgBuffer = NULL;
+
+    if (buffer->Data_Ptr[stateOffset(buffer, thread->msgOffset)] == MSG_READING)
+        messageReady(buffer, thread->msgOffset);
+    else
+        messageFree(buffer, thread->msgOffset);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MsgBufferCreate
+ *
+ * [Description]:   Creates an empty message buffer on caller supplied storage.
+ *                  Use MSGBUF_STORAGE_SIZE to size the storage.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, uint8_t *storage, uint32_t size
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void MsgBufferCreate (MsgBufferHandle_t *buffer, uint8_t *storage, uint32_t size)
+{
+    buffer->Data_Ptr = storage;
+    buffer->capacity = size;
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->used = 0;
+    buffer->ready = 0;
+    buffer->scanned = 0;
+    waitListInit(&buffer->sendWaiters);
+    waitListInit(&buffer->receiveWaiters);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MsgBufferSend
+ *
+ * [Description]:   Copies a message of 1 ~ MSGBUF_MAX_MESSAGE bytes into the
+ *                  buffer, waiting up to timeout Quanta for free space
+ *                  (WAIT_FOREVER for no limit, 0 never waits and is ISR safe).
+ *                  Senders already waiting are served first, in priority order.
+ *                  A waiting receiver is woken once the message is copied in.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, const void *data, uint32_t length,
+ *                  uint32_t timeout
+ * [Return]:        uint8_t
+ *
+ *****************************************************************************/
+uint8_t MsgBufferSend (MsgBufferHandle_t *buffer, const void *data, uint32_t length, uint32_t timeout)
+{
+    uint8_t result = MSGBUF_SUCCESS;
+    MsgBuffer_Request request;
+    TCB *self = g_curr_running_thread;
+    MsgBufferHandle_t *outer = NULL;                        /* Copy of the thread we interrupted, if we're an ISR */
+    uint32_t outerOffset = 0;
+    uint32_t offset = 0;
+
+    if (length == 0 || length > MSGBUF_MAX_MESSAGE || length + MSGBUF_HEADER_SIZE > buffer->capacity)
+        return ERROR_MSGBUF_TOO_LARGE;
+
+    sei();
+
+    if (self != NULL)                                       /* NULL before the kernel starts */
+    {
+        outer = self->msgBuffer;
+        outerOffset = self->msgOffset;
+    }
+
+    if (buffer->sendWaiters.head == NULL && length + MSGBUF_HEADER_SIZE <= buffer->capacity - buffer->used)
+        offset = messageReserve(buffer, length, self);
+
+    else if (timeout == 0)
+        result = ERROR_MSGBUF_FULL;
+
+    else
+    {
+        request.length = length;
+        self->eventBuffer = &request;                       /* The receiver that frees space reserves it for us */
+
+        if (waitOnList(&buffer->sendWaiters, timeout) == WAIT_SUCCESS)
+            offset = self->eventData;
+        else
+        {
+            result = ERROR_MSGBUF_FULL;
+            serveSenders(buffer);                           /* We may have held back smaller messages */
+        }
+    }
+
+    if (result == MSGBUF_SUCCESS)
+    {
+        cli();                                              /* The reserved space is ours alone */
+        ringWrite(buffer, (offset + MSGBUF_HEADER_SIZE) % buffer->capacity, (const uint8_t *)data, length);
+        sei();
+
+        copyOwner(self, outer, outerOffset);
+        messageReady(buffer, offset);
+    }
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MsgBufferReceive
+ *
+ * [Description]:   Copies the oldest message into a caller buffer of maxLength
+ *                  bytes, waiting up to timeout Quanta for one (WAIT_FOREVER for
+ *                  no limit, 0 never waits and is ISR safe). A message larger
+ *                  than maxLength is left in the buffer. Messages still being
+ *                  copied in are skipped. The copy runs with interrupts
+ *                  enabled; its space is freed, and waiting senders served,
+ *                  once every message before it is freed too.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer, void *data, uint32_t maxLength,
+ *                  uint32_t *length, uint32_t timeout
+ * [Return]:        uint8_t
+ *
+ *****************************************************************************/
+uint8_t MsgBufferReceive (MsgBufferHandle_t *buffer, void *data, uint32_t maxLength, uint32_t *length, uint32_t timeout)
+{
+    uint8_t result = MSGBUF_SUCCESS;
+    TCB *self = g_curr_running_thread;
+    MsgBufferHandle_t *outer = NULL;                        /* Copy of the thread we interrupted, if we're an ISR */
+    uint32_t outerOffset = 0;
+    uint32_t next, offset;
+
+    sei();
+
+    if (self != NULL)                                       /* NULL before the kernel starts */
+    {
+        outer = self->msgBuffer;
+        outerOffset = self->msgOffset;
+    }
+
+    while (buffer->ready == 0 && timeout != 0)              /* Woken by a sender, another receiver may take it first */
+    {
+        if (waitOnList(&buffer->receiveWaiters, timeout) != WAIT_SUCCESS)
+            break;
+    }
+
+    if (buffer->ready == 0)
+        result = ERROR_MSGBUF_EMPTY;
+
+    else
+    {
+        offset = messageFind(buffer);
+        next = messageLength(buffer, offset);
+
+        if (next > maxLength)
+            result = ERROR_MSGBUF_TOO_SMALL;
+        else
+        {
+            buffer->Data_Ptr[stateOffset(buffer, offset)] = MSG_READING;
+            buffer->ready--;
+            buffer->scanned += MSGBUF_HEADER_SIZE + next;
+
+            copyOwner(self, buffer, offset);                /* Made ready again by MsgBuffer_AbortCopy if we end first */
+
+            cli();
+            ringRead(buffer, (offset + MSGBUF_HEADER_SIZE) % buffer->capacity, (uint8_t *)data, next);
+            sei();
+
+            copyOwner(self, outer, outerOffset);
+            messageFree(buffer, offset);
+
+            *length = next;
+        }
+
+        if (buffer->ready > 0)                              /* More to receive, pass it on */
+            wakeFromList(&buffer->receiveWaiters, 0);
+    }
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MsgBufferNextLength
+ *
+ * [Description]:   Returns the length of the next message to be received, so
+ *                  the caller can size its buffer. Returns 0 if it's empty.
+ *
+ * [Arguments]:     MsgBufferHandle_t *buffer
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+uint32_t MsgBufferNextLength (MsgBufferHandle_t *buffer)
+{
+    uint32_t length = 0;
+
+    sei();
+
+    if (buffer->ready > 0)
+        length = messageLength(buffer, messageFind(buffer));
+
+    cli();
+
+    return length;
+}
@@ -0,0 +1,306 @@
+/******************************************************************************
+ * [File Name]:     mutex.c
+ *
+ * [Description]:   Priority Inheritance Mutex Implementation Source File
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "mutex.h"
+
+
+/******************************************************************************
+ *
+ * [Function Name]: mutexGiveTo
+ *
+ * [Description]:   Makes a thread the owner of a free mutex and links the mutex
+ *                  to the thread's held mutexes.
+ *
+ * [Arguments]:     MutexHandle_t *mutex, TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void mutexGiveTo (MutexHandle_t *mutex, TCB *thread)
+{
+    mutex->owner = thread;
+    mutex->lockCount = 1;
+    mutex->nextHeld = thread->mutexesHeld;
+    thread->mutexesHeld = mutex;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: mutexRestorePriority
+ *
+ * [Description]:   Recomputes the effective priority of a thread as the highest
+ *                  of its base priority and of the first waiter of every mutex
+ *                  it still holds.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void mutexRestorePriority (TCB *thread)
+{
+    uint8_t priority = thread->basePriority;
+    MutexHandle_t *held;
+
+    for (held = thread->mutexesHeld ; held != NULL ; held = held->nextHeld)
+    {
+        if (held->waiters.head != NULL && held->waiters.head->priority > priority)
+            priority = held->waiters.head->priority;
+    }
+
+    if (priority != thread->priority)
+        threadSetPriority(thread, priority);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: mutexRestoreChain
+ *
+ * [Description]:   Recomputes the priority of a mutex owner after one of its
+ *                  waiters left, then of the owner of the mutex that owner is
+ *                  waiting for, and so on while priorities keep changing. Undoes
+ *                  the transitive inheritance of MutexLock.
+ *
+ * [Arguments]:     MutexHandle_t *mutex
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void mutexRestoreChain (MutexHandle_t *mutex)
+{
+    TCB *owner = mutex->owner;
+    uint8_t previous;
+
+    while (owner != NULL)
+    {
+        previous = owner->priority;
+        mutexRestorePriority(owner);
+
+        if (owner->priority == previous)                    /* Nothing changes further along */
+            break;
+
+        if (owner->status == PENDING && owner->blockingMutex != NULL)
+            owner = owner->blockingMutex->owner;
+        else
+            owner = NULL;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: mutexRelease
+ *
+ * [Description]:   Takes a mutex from its owner and hands it straight to the
+ *                  highest priority waiter, which inherits from the rest. The
+ *                  owner's priority is left to the caller.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     MutexHandle_t *mutex
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void mutexRelease (MutexHandle_t *mutex)
+{
+    MutexHandle_t **link;
+    TCB *waiter;
+
+    for (link = &mutex->owner->mutexesHeld ; *link != NULL ; link = &(*link)->nextHeld)
+    {
+        if (*link == mutex)                                 /* Unlink it from the owner's held mutexes */
+        {
+            *link = mutex->nextHeld;
+            break;
+        }
+    }
+    mutex->owner = NULL;
+    mutex->nextHeld = NULL;
+    mutex->lockCount = 0;
+
+    waiter = wakeFromList(&mutex->waiters, 0);
+
+    if (waiter != NULL)
+    {
+        waiter->blockingMutex = NULL;
+        mutexGiveTo(mutex, waiter);
+        mutexRestorePriority(waiter);
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Mutex_AbortWait
+ *
+ * [Description]:   Called by the kernel when a thread pending on a mutex is
+ *                  taken off its wait list (blocked or deleted). Gives back the
+ *                  priority the thread lent the owners along the chain.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void Mutex_AbortWait (TCB *thread)
+{
+    MutexHandle_t *mutex = thread->blockingMutex;
+
+    if (mutex == NULL)
+        return;
+
+    thread->blockingMutex = NULL;
+    mutexRestoreChain(mutex);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Mutex_ReleaseAll
+ *
+ * [Description]:   Called by the kernel when a thread ends. Every mutex the
+ *                  thread still holds, whatever its lock depth, goes to its
+ *                  highest priority waiter or becomes free.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TCB *thread
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void Mutex_ReleaseAll (TCB *thread)
+{
+    if (thread->mutexesHeld == NULL)
+        return;
+
+    while (thread->mutexesHeld != NULL)
+        mutexRelease(thread->mutexesHeld);
+
+    if (nextThread() != g_curr_running_thread)              /* A new owner may have inherited above us */
+        triggerContextSwitch();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MutexCreate
+ *
+ * [Description]:   Creates an unlocked Mutex
+ *
+ * [Arguments]:     MutexHandle_t *mutex
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void MutexCreate (MutexHandle_t *mutex)
+{
+    mutex->owner = NULL;
+    mutex->lockCount = 0;
+    mutex->nextHeld = NULL;
+    waitListInit(&mutex->waiters);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MutexLock
+ *
+ * [Description]:   Locks the Mutex, the owner may lock it again recursively.
+ *                  If another thread owns it, the caller waits for at most
+ *                  timeout Quanta (WAIT_FOREVER for no limit). While waiting,
+ *                  the owner runs at the caller's priority if it's lower, and
+ *                  so does the owner of any mutex that owner is waiting for.
+ *
+ * [Arguments]:     MutexHandle_t *mutex, uint32_t timeout
+ * [Return]:        uint8_t, MUTEX_SUCCESS or ERROR_MUTEX_TIMEOUT
+ *
+ *****************************************************************************/
+uint8_t MutexLock (MutexHandle_t *mutex, uint32_t timeout)
+{
+    uint8_t result = MUTEX_SUCCESS;
+    TCB *self = g_curr_running_thread;
+    TCB *owner;
+
+    sei();
+
+    if (mutex->owner == NULL)
+        mutexGiveTo(mutex, self);
+
+    else if (mutex->owner == self)
+        mutex->lockCount++;
+
+    else if (timeout == 0)
+        result = ERROR_MUTEX_TIMEOUT;
+
+    else
+    {
+        /* Transitive inheritance along the chain of blocked owners */
+        owner = mutex->owner;
+        while (owner != NULL && owner->priority < self->priority)
+        {
+            threadSetPriority(owner, self->priority);
+
+            if (owner->status == PENDING && owner->blockingMutex != NULL)
+                owner = owner->blockingMutex->owner;
+            else
+                owner = NULL;
+        }
+
+        self->blockingMutex = mutex;
+
+        if (waitOnList(&mutex->waiters, timeout) != WAIT_SUCCESS)
+        {
+            result = ERROR_MUTEX_TIMEOUT;
+            Mutex_AbortWait(self);                          /* Drop what the owners inherited from us */
+        }
+
+        self->blockingMutex = NULL;                         /* On success, MutexUnlock made us the owner */
+    }
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: MutexUnlock
+ *
+ * [Description]:   Unlocks the Mutex. When the last recursive lock is released,
+ *                  the owner's inherited priority is restored and ownership goes
+ *                  straight to the highest priority waiter.
+ *
+ * [Arguments]:     MutexHandle_t *mutex
+ * [Return]:        uint8_t, MUTEX_SUCCESS or ERROR_MUTEX_NOT_OWNER
+ *
+ *****************************************************************************/
+uint8_t MutexUnlock (MutexHandle_t *mutex)
+{
+    TCB *self = g_curr_running_thread;
+
+    sei();
+
+    if (mutex->owner != self)
+    {
+        cli();
+        return ERROR_MUTEX_NOT_OWNER;
+    }
+
+    if (--mutex->lockCount > 0)
+    {
+        cli();
+        return MUTEX_SUCCESS;
+    }
+
+    mutexRelease(mutex);
+    mutexRestorePriority(self);
+
+    if (nextThread() != self)                               /* Our priority may have just dropped */
+        triggerContextSwitch();
+
+    cli();
+
+    return MUTEX_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/******************************************************************************
+ * [File Name]:     notify.c
+ *
+ * [Description]:   Thread Notifications Implementation Source File.
+ *                  Every thread owns a 32-bit notification value in its TCB.
+ *                  Other threads and ISRs update it with Thread_Notify, and the
+ *                  owner takes it like a counting semaphore or waits on it like
+ *                  event flags. A thread can only wait for its own value, so
+ *                  the notification wakes it directly, with no object between.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "notify.h"
+
+#if (THREAD_NOTIFICATIONS == 1)
+
+/******************************************************************************
+ *
+ * [Function Name]: Thread_Notify
+ *
+ * [Description]:   Updates a thread's notification value as action says and
+ *                  marks a notification pending. If the thread is waiting for
+ *                  one, it's made ready right away. NOTIFY_SET_IF_EMPTY leaves
+ *                  the value alone while the previous notification is pending.
+ *                  ISR safe.
+ *
+ * [Arguments]:     ThreadHandle_t thread, uint32_t value, uint8_t action
+ * [Return]:        uint8_t, NOTIFY_SUCCESS, ERROR_NOTIFY_PENDING if
+ *                  NOTIFY_SET_IF_EMPTY found a pending notification, or
+ *                  ERROR_NOTIFY_INVALID
+ *
+ *****************************************************************************/
+uint8_t Thread_Notify (ThreadHandle_t thread, uint32_t value, uint8_t action)
+{
+    uint8_t result = NOTIFY_SUCCESS;
+
+    if (thread == NULL || action > NOTIFY_SET_IF_EMPTY)
+        return ERROR_NOTIFY_INVALID;
+
+    sei();
+
+    switch (action)
+    {
+    case NOTIFY_INCREMENT:
+        thread->notifyValue = thread->notifyValue + 1;
+        break;
+    case NOTIFY_SET_BITS:
+        thread->notifyValue = thread->notifyValue | value;
+        break;
+    case NOTIFY_OVERWRITE:
+        thread->notifyValue = value;
+        break;
+    default:                                                /* NOTIFY_SET_IF_EMPTY */
+        if (thread->notifyPending)
+            result = ERROR_NOTIFY_PENDING;
+        else
+            thread->notifyValue = value;
+        break;
+    }
+
+    if (result == NOTIFY_SUCCESS)
+    {
+        thread->notifyPending = 1;
+        wakeFromList(&thread->notifyWait, 0);               /* Holds the thread only if it's waiting */
+    }
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Thread_NotifyTake
+ *
+ * [Description]:   Takes the calling thread's notification value like a
+ *                  counting semaphore. If the value is 0, waits at most timeout
+ *                  Quanta (WAIT_FOREVER for no limit) for a notification. The
+ *                  value is then decremented, or cleared with clearOnExit.
+ *
+ * [Arguments]:     uint8_t clearOnExit, uint32_t timeout
+ * [Return]:        uint32_t, Value before it was decremented or cleared, 0 on
+ *                  timeout
+ *
+ *****************************************************************************/
+uint32_t Thread_NotifyTake (uint8_t clearOnExit, uint32_t timeout)
+{
+    TCB *thread = g_curr_running_thread;
+    uint32_t value;
+
+    sei();
+
+    if (thread->notifyValue == 0 && timeout != 0)
+        waitOnList(&thread->notifyWait, timeout);
+
+    value = thread->notifyValue;
+    if (value != 0)
+        thread->notifyValue = clearOnExit ? 0 : value - 1;
+
+    thread->notifyPending = 0;
+
+    cli();
+
+    return value;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Thread_NotifyWait
+ *
+ * [Description]:   Waits at most timeout Quanta (WAIT_FOREVER for no limit) for
+ *                  a notification to the calling thread, unless one is already
+ *                  pending. The bits of clearOnEntry are cleared before waiting,
+ *                  and the bits of clearOnExit once notified, after the value
+ *                  has been copied to value (may be NULL).
+ *
+ * [Arguments]:     uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t *value,
+ *                  uint32_t timeout
+ * [Return]:        uint8_t, NOTIFY_SUCCESS or ERROR_NOTIFY_TIMEOUT
+ *
+ *****************************************************************************/
+uint8_t Thread_NotifyWait (uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t *value, uint32_t timeout)
+{
+    TCB *thread = g_curr_running_thread;
+    uint8_t result = NOTIFY_SUCCESS;
+
+    sei();
+
+    if (!thread->notifyPending)
+    {
+        thread->notifyValue = thread->notifyValue & ~clearOnEntry;
+
+        if (timeout != 0)
+            waitOnList(&thread->notifyWait, timeout);
+    }
+
+    if (value != NULL)
+        *value = thread->notifyValue;
+
+    if (thread->notifyPending)
+    {
+        thread->notifyValue = thread->notifyValue & ~clearOnExit;
+        thread->notifyPending = 0;
+    }
+    else
+        result = ERROR_NOTIFY_TIMEOUT;
+
+    cli();
+
+    return result;
+}
+
+#endif
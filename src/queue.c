@@ -7,14 +7,16 @@
  *
  *******************************************************************************/
 #include "queue.h"
-#include <stdlib.h>
+#include "heap.h"
+#include "trace.h"
 
 
+#if (DYNAMIC_ALLOCATION == 1)
 /******************************************************************************
  *
  * [Function Name]: QueueCreate
  *
- * [Description]:   Responsible Dynamic Allocating a queue in heap segment
+ * [Description]:   Responsible Dynamic Allocating a queue in the kernel heap
  *                  according to a given length and size.
  *
  * [Arguments]:     uint32_t length, uint8_t size
@@ -23,25 +25,60 @@
  *****************************************************************************/
 QueueHandle_t QueueCreate(uint32_t length, uint8_t size)
 {
+    xQUEUE *queueBuffer;
+    uint32_t *storage;
 
-    QueueHandle_t queue = (QueueHandle_t) malloc(sizeof(xQUEUE));
+    if (size == 0 || size > sizeof(uint32_t))
+        return NULL;
 
-    if (queue == NULL)
+    queueBuffer = (xQUEUE *) HeapAlloc(sizeof(xQUEUE));
+
+    if (queueBuffer == NULL)
         return NULL;
 
-    else
+    storage = (uint32_t *) HeapAlloc(QUEUE_STORAGE_WORDS(length,size) * sizeof(uint32_t));
+
+    if (storage == NULL)
     {
-        queue->tail = 0;
-        queue->head = 0;
-        queue->length = length;
-        queue->Data_Ptr = (uint32_t *) calloc(length,size);
-        queue->size = 0;
-
-        if(queue->Data_Ptr == NULL)
-            return NULL;
-        else
-            return queue;
+        HeapFree(queueBuffer);                              /* Don't leak the control block */
+        return NULL;
     }
+
+    return QueueCreateStatic(length, size, queueBuffer, storage);
+}
+#endif
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueCreateStatic
+ *
+ * [Description]:   Creates a queue on caller supplied memory, without using
+ *                  the heap. storage must hold QUEUE_STORAGE_WORDS(length,size)
+ *                  words. Items are uint32_t words, so size must be 1 ~ 4.
+ *
+ * [Arguments]:     uint32_t length, uint8_t size, xQUEUE *queueBuffer,
+ *                  uint32_t *storage
+ * [Return]:        QueueHandle_t
+ *
+ *****************************************************************************/
+QueueHandle_t QueueCreateStatic(uint32_t length, uint8_t size, xQUEUE *queueBuffer, uint32_t *storage)
+{
+    QueueHandle_t queue = queueBuffer;
+
+    if (queue == NULL || storage == NULL || size == 0 || size > sizeof(uint32_t))
+        return NULL;
+
+    queue->tail = 0;
+    queue->head = 0;
+    queue->length = length;
+    queue->Data_Ptr = storage;
+    queue->size = 0;
+    waitListInit(&queue->sendWaiters);
+    waitListInit(&queue->receiveWaiters);
+    QUEUE_SET_LINK_INIT(&queue->setLink, queue, QUEUESET_MEMBER_QUEUE);
+
+    return queue;
 }
 
 
@@ -50,7 +87,7 @@ QueueHandle_t QueueCreate(uint32_t length, uint8_t size)
  * [Function Name]: QueueWrite
  *
  * [Description]:   Function responsible for writing the required data to the
- *                  next free space in the FIFO queue.
+ *                  next free space in the FIFO queue. Doesn't wait, ISR safe.
  *
  * [Arguments]:     QueueHandle_t queue, uint32_t data
  * [Return]:        int8_t
@@ -58,50 +95,140 @@ QueueHandle_t QueueCreate(uint32_t length, uint8_t size)
  *****************************************************************************/
 uint8_t QueueWrite(QueueHandle_t queue, uint32_t data)
 {
+    return QueueWriteTimeout(queue, data, 0);
+}
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueReceive
+ *
+ * [Description]:   Function responsible for reading the required data
+ *                  in the FIFO queue. Doesn't wait, ISR safe.
+ *
+ * [Arguments]:     QueueHandle_t queue, uint32_t *var
+ * [Return]:        int8_t
+ *
+ *****************************************************************************/
+
+uint8_t QueueReceive(QueueHandle_t queue,uint32_t *var)
+{
+    return QueueReceiveTimeout(queue, var, 0);
+}
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueWriteTimeout
+ *
+ * [Description]:   Writes data to the queue, waiting up to timeout ticks for
+ *                  a free slot (WAIT_FOREVER for no limit). If a receiver is
+ *                  already waiting, the data is handed straight to it and it
+ *                  becomes ready, without going through the buffer.
+ *
+ * [Arguments]:     QueueHandle_t queue, uint32_t data, uint32_t timeout
+ * [Return]:        int8_t
+ *
+ *****************************************************************************/
+uint8_t QueueWriteTimeout(QueueHandle_t queue, uint32_t data, uint32_t timeout)
+{
+    uint8_t result = SUCCESS;
+
     if (queue == NULL)
         return ERROR_QUEUE_NULL;
-        
-    else if (QueueIsFull(queue))
-        return ERROR_QUEUE_FULL;
 
-    else
+    sei();
+
+    TRACE_EVENT(TRACE_EVENT_QUEUE_SEND, Trace_CurrentSlot(), TRACE_OBJECT(queue));
+
+    if (queue->receiveWaiters.head != NULL)                 /* Receivers only wait on an empty queue */
+        wakeFromList(&queue->receiveWaiters, data);
+
+    else if (!QueueIsFull(queue))
     {
-        queue->Data_Ptr[queue->tail] = (size_t)data;
+        queue->Data_Ptr[queue->tail] = data;
         queue->tail = (queue->tail + 1) % (queue->length);
         queue->size  = queue->size + 1;
+
+        QUEUE_SET_NOTIFY(&queue->setLink);
+    }
+
+    else if (timeout == 0)
+        result = ERROR_QUEUE_FULL;
+
+    else
+    {
+        g_curr_running_thread->eventData = data;            /* The receiver that frees a slot stores it for us */
+
+        if (waitOnList(&queue->sendWaiters, timeout) != WAIT_SUCCESS)
+            result = ERROR_QUEUE_FULL;
     }
-    return SUCCESS;
+
+    cli();
+
+    return result;
 }
 
 /******************************************************************************
  *
- * [Function Name]: QueueReceive
+ * [Function Name]: QueueReceiveTimeout
  *
- * [Description]:   Function responsible for reading the required data
- *                  in the FIFO queue.
+ * [Description]:   Reads data from the queue, waiting up to timeout ticks for
+ *                  an item (WAIT_FOREVER for no limit). Reading from a full
+ *                  queue moves the data of the highest priority waiting
+ *                  sender into the freed slot and makes that sender ready.
  *
- * [Arguments]:     QueueHandle_t queue, uint32_t *var
+ * [Arguments]:     QueueHandle_t queue, uint32_t *var, uint32_t timeout
  * [Return]:        int8_t
  *
  *****************************************************************************/
-
-uint8_t QueueReceive(QueueHandle_t queue,uint32_t *var)
+uint8_t QueueReceiveTimeout(QueueHandle_t queue, uint32_t *var, uint32_t timeout)
 {
+    uint8_t result = SUCCESS;
+    TCB *sender;
+
     if (queue == NULL)
         return ERROR_QUEUE_NULL;
 
-    else if (QueueIsEmpty(queue))
-        return ERROR_QUEUE_EMPTY;
+    sei();
 
-    else
+    TRACE_EVENT(TRACE_EVENT_QUEUE_RECEIVE, Trace_CurrentSlot(), TRACE_OBJECT(queue));
+
+    if (!QueueIsEmpty(queue))
     {
         *var = (queue->Data_Ptr[queue->head]);
 
         queue->head = (queue->head + 1) % (queue->length);
 
         queue->size  = queue->size - 1;
+
+        sender = queue->sendWaiters.head;
+
+        if (sender != NULL)                                 /* Complete the write of the first waiting sender */
+        {
+            queue->Data_Ptr[queue->tail] = sender->eventData;
+            queue->tail = (queue->tail + 1) % (queue->length);
+            queue->size  = queue->size + 1;
+
+            wakeFromList(&queue->sendWaiters, 0);
+        }
+
+        if (!QueueIsEmpty(queue))
+            QUEUE_SET_NOTIFY(&queue->setLink);              /* Items left, keep it ready in its set */
+    }
+
+    else if (timeout == 0)
+        result = ERROR_QUEUE_EMPTY;
+
+    else
+    {
+        if (waitOnList(&queue->receiveWaiters, timeout) == WAIT_SUCCESS)
+            *var = g_curr_running_thread->eventData;        /* Handed over by the writer */
+        else
+            result = ERROR_QUEUE_EMPTY;
     }
-    return SUCCESS;
+
+    cli();
+
+    return result;
 }
 
 /******************************************************************************
@@ -0,0 +1,321 @@
+/******************************************************************************
+ * [File Name]:     queueset.c
+ *
+ * [Description]:   Queue Sets Implementation Source File.
+ *                  Queues and semaphores joined to a set add themselves to the
+ *                  set's ready list when they get an item or a token, in O(1),
+ *                  or hand themselves straight to a thread waiting on the set.
+ *                  A member stays in the list until QueueSetSelect returns it;
+ *                  receiving from it puts it back while it has more to give.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "queueset.h"
+#include "queue.h"
+#include "semaphore.h"
+
+#if (QUEUE_SETS == 1)
+
+/******************************************************************************
+ *
+ * [Function Name]: memberReady
+ *
+ * [Description]:   Checks that a member can still be received from, it may
+ *                  have been emptied directly since it joined the ready list.
+ *
+ * [Arguments]:     QueueSetLink *link
+ * [Return]:        uint8_t, 1 if ready
+ *
+ *****************************************************************************/
+static uint8_t memberReady (QueueSetLink *link)
+{
+    if (link->type == QUEUESET_MEMBER_QUEUE)
+        return !QueueIsEmpty((QueueHandle_t)link->object);
+
+    return ((SemaphoreHandle_t *)link->object)->count > 0;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: memberAdd
+ *
+ * [Description]:   Joins a member to a set. A member that already holds items
+ *                  is ready in the set right away.
+ *
+ * [Arguments]:     QueueSetHandle_t *set, QueueSetLink *link
+ * [Return]:        uint8_t, QUEUESET_SUCCESS or ERROR_QUEUESET_INVALID if it
+ *                  belongs to a set already
+ *
+ *****************************************************************************/
+static uint8_t memberAdd (QueueSetHandle_t *set, QueueSetLink *link)
+{
+    uint8_t result = QUEUESET_SUCCESS;
+
+    sei();
+
+    if (link->set != NULL)
+        result = ERROR_QUEUESET_INVALID;
+    else
+    {
+        link->set = set;
+
+        if (memberReady(link))
+            QueueSet_Notify(link);
+    }
+
+    cli();
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: memberRemove
+ *
+ * [Description]:   Takes a member out of its set and of the set's ready list.
+ *
+ * [Arguments]:     QueueSetHandle_t *set, QueueSetLink *link
+ * [Return]:        uint8_t, QUEUESET_SUCCESS or ERROR_QUEUESET_INVALID if it
+ *                  isn't a member of set
+ *
+ *****************************************************************************/
+static uint8_t memberRemove (QueueSetHandle_t *set, QueueSetLink *link)
+{
+    QueueSetLink **cursor;
+    QueueSetLink *previous = NULL;
+
+    sei();
+
+    if (link->set != set)
+    {
+        cli();
+        return ERROR_QUEUESET_INVALID;
+    }
+
+    if (link->linked)
+    {
+        for (cursor = &set->head ; *cursor != link ; cursor = &(*cursor)->next)
+            previous = *cursor;
+
+        *cursor = link->next;
+        if (set->tail == link)
+            set->tail = previous;
+
+        link->linked = 0;
+    }
+
+    link->set = NULL;
+
+    cli();
+
+    return QUEUESET_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSet_LinkInit
+ *
+ * [Description]:   Initializes the set link of a new queue or semaphore, which
+ *                  doesn't belong to any set.
+ *
+ * [Arguments]:     QueueSetLink *link, void *object, uint8_t type
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void QueueSet_LinkInit (QueueSetLink *link, void *object, uint8_t type)
+{
+    link->set = NULL;
+    link->next = NULL;
+    link->object = object;
+    link->type = type;
+    link->linked = 0;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSet_Notify
+ *
+ * [Description]:   Called by a member that got an item or a token. Hands it to
+ *                  the highest priority thread waiting on its set, otherwise
+ *                  appends it to the set's ready list unless it's there already.
+ *                  Must be called with interrupts disabled. ISR safe.
+ *
+ * [Arguments]:     QueueSetLink *link
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void QueueSet_Notify (QueueSetLink *link)
+{
+    QueueSetHandle_t *set = link->set;
+    TCB *waiter;
+
+    if (set == NULL || link->linked)
+        return;
+
+    waiter = set->waiters.head;                             /* Threads only wait on an empty ready list */
+
+    if (waiter != NULL)
+    {
+        *(void **)waiter->eventBuffer = link->object;
+        wakeThread(waiter, 0);
+        return;
+    }
+
+    link->next = NULL;
+    link->linked = 1;
+
+    if (set->tail == NULL)
+        set->head = link;
+    else
+        set->tail->next = link;
+    set->tail = link;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSetCreate
+ *
+ * [Description]:   Creates an empty queue set.
+ *
+ * [Arguments]:     QueueSetHandle_t *set
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void QueueSetCreate (QueueSetHandle_t *set)
+{
+    set->head = NULL;
+    set->tail = NULL;
+    waitListInit(&set->waiters);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSetAddQueue
+ *
+ * [Description]:   Joins a queue to a set. A queue belongs to one set at most.
+ *
+ * [Arguments]:     QueueSetHandle_t *set, QueueHandle_t queue
+ * [Return]:        uint8_t, QUEUESET_SUCCESS or ERROR_QUEUESET_INVALID
+ *
+ *****************************************************************************/
+uint8_t QueueSetAddQueue (QueueSetHandle_t *set, QueueHandle_t queue)
+{
+    if (set == NULL || queue == NULL)
+        return ERROR_QUEUESET_INVALID;
+
+    return memberAdd(set, &queue->setLink);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSetAddSemaphore
+ *
+ * [Description]:   Joins a semaphore to a set. A semaphore belongs to one set
+ *                  at most.
+ *
+ * [Arguments]:     QueueSetHandle_t *set, SemaphoreHandle_t *semaphore
+ * [Return]:        uint8_t, QUEUESET_SUCCESS or ERROR_QUEUESET_INVALID
+ *
+ *****************************************************************************/
+uint8_t QueueSetAddSemaphore (QueueSetHandle_t *set, SemaphoreHandle_t *semaphore)
+{
+    if (set == NULL || semaphore == NULL)
+        return ERROR_QUEUESET_INVALID;
+
+    return memberAdd(set, &semaphore->setLink);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSetRemoveQueue
+ *
+ * [Description]:   Takes a queue out of a set.
+ *
+ * [Arguments]:     QueueSetHandle_t *set, QueueHandle_t queue
+ * [Return]:        uint8_t, QUEUESET_SUCCESS or ERROR_QUEUESET_INVALID
+ *
+ *****************************************************************************/
+uint8_t QueueSetRemoveQueue (QueueSetHandle_t *set, QueueHandle_t queue)
+{
+    if (set == NULL || queue == NULL)
+        return ERROR_QUEUESET_INVALID;
+
+    return memberRemove(set, &queue->setLink);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSetRemoveSemaphore
+ *
+ * [Description]:   Takes a semaphore out of a set.
+ *
+ * [Arguments]:     QueueSetHandle_t *set, SemaphoreHandle_t *semaphore
+ * [Return]:        uint8_t, QUEUESET_SUCCESS or ERROR_QUEUESET_INVALID
+ *
+ *****************************************************************************/
+uint8_t QueueSetRemoveSemaphore (QueueSetHandle_t *set, SemaphoreHandle_t *semaphore)
+{
+    if (set == NULL || semaphore == NULL)
+        return ERROR_QUEUESET_INVALID;
+
+    return memberRemove(set, &semaphore->setLink);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: QueueSetSelect
+ *
+ * [Description]:   Returns the member of a set that became ready first, waiting
+ *                  at most timeout Quanta (WAIT_FOREVER for no limit) if none
+ *                  is. Receive from the returned member with a 0 timeout; if
+ *                  it's left unread, the set forgets it until its next post.
+ *
+ * [Arguments]:     QueueSetHandle_t *set, uint32_t timeout
+ * [Return]:        void *, the QueueHandle_t or the semaphore address that is
+ *                  ready, NULL on timeout
+ *
+ *****************************************************************************/
+void *QueueSetSelect (QueueSetHandle_t *set, uint32_t timeout)
+{
+    QueueSetLink *link;
+    void *member = NULL;
+
+    if (set == NULL)
+        return NULL;
+
+    sei();
+
+    while (member == NULL && (link = set->head) != NULL)
+    {
+        set->head = link->next;
+        if (set->head == NULL)
+            set->tail = NULL;
+        link->linked = 0;
+
+        if (memberReady(link))                              /* Skip members emptied directly meanwhile */
+            member = link->object;
+    }
+
+    if (member == NULL && timeout != 0)
+    {
+        g_curr_running_thread->eventBuffer = &member;       /* QueueSet_Notify stores the member here */
+        waitOnList(&set->waiters, timeout);
+    }
+
+    cli();
+
+    return member;
+}
+
+#endif
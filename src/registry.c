@@ -0,0 +1,148 @@
+/******************************************************************************
+ * [File Name]:     registry.c
+ *
+ * [Description]:   Thread Name Registry Source File. Maps a thread name to its
+ *                  handle through an open addressing hash table, so resolving
+ *                  a name doesn't walk every TCB. The kernel itself only works
+ *                  with handles; the registry is only needed by applications
+ *                  that look threads up by name.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "registry.h"
+
+#if (THREAD_REGISTRY == 1)
+
+/*******************************************************************************
+ *                          Global Variables
+ ******************************************************************************/
+static TCB *g_Registry[REGISTRY_SLOTS];
+
+/* Marks a slot whose thread was removed, lookups keep probing past it.
+ * The table's own address can't be a TCB. */
+#define REGISTRY_DELETED        ((TCB *)g_Registry)
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     registryHash
+ *
+ * [Description]:       FNV-1a hash of a thread name, reduced to a table slot.
+ *                      Only the characters the TCB keeps are hashed, so a name
+ *                      longer than that hashes like its stored copy.
+ *
+ * [Arguments]:         const uint8_t *name
+ * [Return]:            uint32_t
+ *
+ *****************************************************************************/
+static uint32_t registryHash (const uint8_t *name)
+{
+    uint32_t hash = 2166136261UL;
+    uint32_t length = THREAD_ID_MAX_LENGTH - 1;
+
+    while (*name && length--)
+    {
+        hash ^= *name;
+        hash *= 16777619UL;
+        name++;
+    }
+
+    return hash % REGISTRY_SLOTS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Registry_Add
+ *
+ * [Description]:       Subroutine that registers a thread under its ThreadID.
+ *                      Called by ThreadCreate with interrupts disabled. The table
+ *                      has more slots than threads, so a free one always exists.
+ *
+ * [Arguments]:         TCB *thread
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Registry_Add (TCB *thread)
+{
+    uint32_t slot = registryHash(thread->ThreadID);
+
+    while (g_Registry[slot] != NULL && g_Registry[slot] != REGISTRY_DELETED)
+        slot = (slot + 1) % REGISTRY_SLOTS;                 /* Linear probing */
+
+    g_Registry[slot] = thread;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Registry_Remove
+ *
+ * [Description]:       Subroutine that unregisters a thread. Called with
+ *                      interrupts disabled.
+ *
+ * [Arguments]:         TCB *thread
+ * [Return]:            void
+ *
+ *****************************************************************************/
+void Registry_Remove (TCB *thread)
+{
+    uint32_t slot = registryHash(thread->ThreadID);
+    uint32_t probes;
+
+    for (probes = 0 ; probes < REGISTRY_SLOTS && g_Registry[slot] != NULL ; probes++)
+    {
+        if (g_Registry[slot] == thread)
+        {
+            g_Registry[slot] = REGISTRY_DELETED;
+            return;
+        }
+        slot = (slot + 1) % REGISTRY_SLOTS;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]:     Thread_GetHandle
+ *
+ * [Description]:       API Function that resolves a thread name to its handle.
+ *                      Meant to be called once, at start-up; keep the handle for
+ *                      Thread_Block / Thread_Resume calls in hot paths. Names
+ *                      are matched on the THREAD_ID_MAX_LENGTH - 1 characters
+ *                      ThreadCreate keeps.
+ *
+ * [Arguments]:         const uint8_t *ThreadID
+ * [Return]:            ThreadHandle_t, NULL if no thread has that name
+ *
+ *****************************************************************************/
+ThreadHandle_t Thread_GetHandle (const uint8_t *ThreadID)
+{
+    uint32_t slot;
+    uint32_t probes;
+    TCB *found = NULL;
+
+    if (ThreadID == NULL)
+        return NULL;
+
+    slot = registryHash(ThreadID);
+
+    sei();
+
+    for (probes = 0 ; probes < REGISTRY_SLOTS && g_Registry[slot] != NULL ; probes++)
+    {
+        if (g_Registry[slot] != REGISTRY_DELETED && strncmp(ThreadID, g_Registry[slot]->ThreadID, THREAD_ID_MAX_LENGTH - 1) == 0)
+        {
+            found = g_Registry[slot];
+            break;
+        }
+        slot = (slot + 1) % REGISTRY_SLOTS;
+    }
+
+    cli();
+
+    return found;
+}
+
+#endif
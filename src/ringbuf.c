@@ -0,0 +1,142 @@
+/******************************************************************************
+ * [File Name]:     ringbuf.c
+ *
+ * [Description]:   Lock-free Ring Buffer Implementation Source File.
+ *                  ISRs and threads can write without disabling interrupts.
+ *                  Positions are free running counters, a slot is found by
+ *                  masking them with (length - 1), so no division is needed.
+ *                  Every slot carries a sequence number:
+ *                      sequence == position      -> free for the producer
+ *                      sequence == position + 1  -> holds data for the consumer
+ *                  In RINGBUF_MPSC mode producers claim positions with
+ *                  LDREX / STREX, a producer preempted between its claim and
+ *                  its publish only delays the consumer, nobody spins on it.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "ringbuf.h"
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RingBufCreate
+ *
+ * [Description]:   Creates an empty ring buffer on caller supplied slots.
+ *
+ * [Arguments]:     RingBufHandle_t *ring, RingBuf_Slot *slots, uint32_t length,
+ *                  uint8_t mode
+ * [Return]:        uint8_t, ERROR_RINGBUF_LENGTH if length isn't a power of two
+ *
+ *****************************************************************************/
+uint8_t RingBufCreate (RingBufHandle_t *ring, RingBuf_Slot *slots, uint32_t length, uint8_t mode)
+{
+    uint32_t Idx;
+
+    if (length < 2 || (length & (length - 1)) != 0)
+        return ERROR_RINGBUF_LENGTH;
+
+    for (Idx = 0 ; Idx < length ; Idx++)
+        slots[Idx].sequence = Idx;
+
+    ring->Slots_Ptr = slots;
+    ring->mask = length - 1;
+    ring->tail = 0;
+    ring->head = 0;
+    ring->mode = mode;
+
+    return RINGBUF_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RingBufWrite
+ *
+ * [Description]:   Writes one word to the ring. Never waits, ISR safe.
+ *
+ * [Arguments]:     RingBufHandle_t *ring, uint32_t data
+ * [Return]:        uint8_t, RINGBUF_SUCCESS or ERROR_RINGBUF_FULL
+ *
+ *****************************************************************************/
+uint8_t RingBufWrite (RingBufHandle_t *ring, uint32_t data)
+{
+    RingBuf_Slot *slot;
+    uint32_t position;
+    int32_t lap;
+
+    while (1)
+    {
+        position = ring->tail;
+        slot = &ring->Slots_Ptr[position & ring->mask];
+        lap = (int32_t)(slot->sequence - position);
+
+        if (lap < 0)                                        /* Still holds unread data from the previous lap */
+            return ERROR_RINGBUF_FULL;
+
+        if (lap == 0)
+        {
+            if (ring->mode == RINGBUF_SPSC)
+            {
+                ring->tail = position + 1;
+                break;
+            }
+
+            if (Port_CompareAndSwap(&ring->tail, position, position + 1))
+                break;
+        }
+        /* Otherwise another producer claimed this position first, try the next one */
+    }
+
+    slot->data = data;
+    PORT_DMB();                                             /* Data must be visible before it's published */
+    slot->sequence = position + 1;
+
+    return RINGBUF_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RingBufRead
+ *
+ * [Description]:   Reads the oldest published word. Must only be called by the
+ *                  single consumer. Never waits.
+ *
+ * [Arguments]:     RingBufHandle_t *ring, uint32_t *data
+ * [Return]:        uint8_t, RINGBUF_SUCCESS or ERROR_RINGBUF_EMPTY
+ *
+ *****************************************************************************/
+uint8_t RingBufRead (RingBufHandle_t *ring, uint32_t *data)
+{
+    uint32_t position = ring->head;
+    RingBuf_Slot *slot = &ring->Slots_Ptr[position & ring->mask];
+
+    if (slot->sequence != position + 1)                     /* Not written, or claimed but not published yet */
+        return ERROR_RINGBUF_EMPTY;
+
+    PORT_DMB();
+    *data = slot->data;
+    PORT_DMB();                                             /* Finish reading before the slot is handed back */
+    slot->sequence = position + ring->mask + 1;             /* Free for the producer of the next lap */
+    ring->head = position + 1;
+
+    return RINGBUF_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RingBufCount
+ *
+ * [Description]:   Returns the number of claimed slots. Only a snapshot while
+ *                  producers are running.
+ *
+ * [Arguments]:     RingBufHandle_t *ring
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+uint32_t RingBufCount (RingBufHandle_t *ring)
+{
+    return ring->tail - ring->head;
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+ *
+ * [File Name]:     runstats.c
+ *
+ * [Description]:   Run Time Accounting Source File.
+ *                  Pure arithmetic with no hardware access, so it can be
+ *                  compiled and checked on the host. The kernel feeds it the
+ *                  time between context switches and rotates the buckets
+ *                  every RUNTIME_STATS_BUCKET_TICKS ticks.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#include "runstats.h"
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RunStats_Reset
+ *
+ * [Description]:   Clears every counter, for a new thread.
+ *
+ * [Arguments]:     RunStats *stats
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void RunStats_Reset (RunStats *stats)
+{
+    uint8_t Idx;
+
+    stats->total = 0;
+    stats->current = 0;
+    stats->switches = 0;
+
+    for (Idx = 0 ; Idx < RUNTIME_STATS_BUCKETS ; Idx++)
+        stats->buckets[Idx] = 0;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RunStats_Charge
+ *
+ * [Description]:   Adds elapsed time units to the total and the current bucket.
+ *
+ * [Arguments]:     RunStats *stats, uint32_t elapsed
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void RunStats_Charge (RunStats *stats, uint32_t elapsed)
+{
+    stats->total += elapsed;
+    stats->current += elapsed;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RunStats_Rotate
+ *
+ * [Description]:   Closes the current bucket into the bucket slot given, which
+ *                  holds the oldest one, and starts a new current bucket.
+ *
+ * [Arguments]:     RunStats *stats, uint8_t bucket
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void RunStats_Rotate (RunStats *stats, uint8_t bucket)
+{
+    stats->buckets[bucket] = stats->current;
+    stats->current = 0;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RunStats_WindowTime
+ *
+ * [Description]:   Time spent over the sliding window: the closed buckets plus
+ *                  the current one.
+ *
+ * [Arguments]:     const RunStats *stats
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+uint32_t RunStats_WindowTime (const RunStats *stats)
+{
+    uint32_t time = stats->current;
+    uint8_t Idx;
+
+    for (Idx = 0 ; Idx < RUNTIME_STATS_BUCKETS ; Idx++)
+        time += stats->buckets[Idx];
+
+    return time;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: RunStats_Percent
+ *
+ * [Description]:   part as a share of whole, rounded, in hundredths of a percent.
+ *
+ * [Arguments]:     uint32_t part, uint32_t whole
+ * [Return]:        uint16_t, 0 to RUNSTATS_PERCENT_FULL, 0 if whole is 0
+ *
+ *****************************************************************************/
+uint16_t RunStats_Percent (uint32_t part, uint32_t whole)
+{
+    if (whole == 0)
+        return 0;
+
+    if (part >= whole)
+        return RUNSTATS_PERCENT_FULL;
+
+    return (uint16_t)(((uint64_t)part * RUNSTATS_PERCENT_FULL + whole / 2) / whole);
+}
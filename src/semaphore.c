@@ -7,10 +7,7 @@
  *
  *******************************************************************************/
 #include "semaphore.h"
-
-extern void Thread_Suspend (uint32_t port_DELAY);
-extern void sei (void);
-extern void cli (void);
+#include "trace.h"
 
 /******************************************************************************
  *
@@ -24,14 +21,17 @@ extern void cli (void);
  *****************************************************************************/
 void SemaphoreCreateBinary (SemaphoreHandle_t *semaphore)
 {
-    *semaphore = 1;
+    semaphore->count = 1;
+    semaphore->maxCount = 1;
+    waitListInit(&semaphore->waiters);
+    QUEUE_SET_LINK_INIT(&semaphore->setLink, semaphore, QUEUESET_MEMBER_SEMAPHORE);
 }
 
 /******************************************************************************
  *
  * [Function Name]: CreateSemaphore
  *
- * [Description]:   Creates a binary Semaphore with an initial state of Given '1'
+ * [Description]:   Creates a counting Semaphore with an initial number of tokens
  *
  * [Arguments]:     SemaphoreHandle_t *semaphore, uint32_t num_of_tokens
  * [Return]:        void
@@ -39,36 +39,56 @@ void SemaphoreCreateBinary (SemaphoreHandle_t *semaphore)
  *****************************************************************************/
 void SemaphoreCreate (SemaphoreHandle_t *semaphore, uint32_t num_of_tokens)
 {
-    *semaphore = num_of_tokens;
+    semaphore->count = num_of_tokens;
+    semaphore->maxCount = 0xFFFFFFFF;
+    waitListInit(&semaphore->waiters);
+    QUEUE_SET_LINK_INIT(&semaphore->setLink, semaphore, QUEUESET_MEMBER_SEMAPHORE);
 }
 
 /******************************************************************************
  *
  * [Function Name]: SemaphorePend
  *
- * [Description]:   Creates a binary Semaphore with an initial state of Given '1'
+ * [Description]:   Takes one token of the Semaphore. If there are no tokens, the
+ *                  calling thread waits in the semaphore wait list for at most
+ *                  timeout Quanta (WAIT_FOREVER for no limit) until a post hands
+ *                  it a token. A timeout of 0 never waits and is ISR safe.
  *
- * [Arguments]:     SemaphoreHandle_t *semaphore, uint32_t ThreadDelay
- * [Return]:        void
+ * [Arguments]:     SemaphoreHandle_t *semaphore, uint32_t timeout
+ * [Return]:        uint8_t, SEMAPHORE_SUCCESS or ERROR_SEMAPHORE_TIMEOUT
  *
  *****************************************************************************/
-void SemaphorePend (SemaphoreHandle_t *semaphore, uint32_t ThreadDelay)
+uint8_t SemaphorePend (SemaphoreHandle_t *semaphore, uint32_t timeout)
 {
+    uint8_t result = SEMAPHORE_SUCCESS;
+
     sei();
-    
-    while(*semaphore == 0)
-        Thread_Suspend(ThreadDelay);
 
-    *semaphore = *semaphore - 1;
+    TRACE_EVENT(TRACE_EVENT_SEM_PEND, Trace_CurrentSlot(), TRACE_OBJECT(semaphore));
+
+    if (semaphore->count > 0)
+    {
+        semaphore->count = semaphore->count - 1;
+
+        if (semaphore->count > 0)
+            QUEUE_SET_NOTIFY(&semaphore->setLink);          /* Tokens left, keep it ready in its set */
+    }
+
+    else if (timeout == 0 || waitOnList(&semaphore->waiters, timeout) != WAIT_SUCCESS)
+        result = ERROR_SEMAPHORE_TIMEOUT;
 
     cli();
+
+    return result;
 }
 
 /******************************************************************************
  *
  * [Function Name]: SemaphorePost
  *
- * [Description]:   Creates a binary Semaphore with an initial state of Given '1'
+ * [Description]:   Gives one token of the Semaphore. If threads are waiting, the
+ *                  token goes straight to the highest priority one and it's made
+ *                  ready, otherwise the token count is increased. ISR safe.
  *
  * [Arguments]:     SemaphoreHandle_t *semaphore
  * [Return]:        void
@@ -77,6 +97,14 @@ void SemaphorePend (SemaphoreHandle_t *semaphore, uint32_t ThreadDelay)
 void SemaphorePost (SemaphoreHandle_t *semaphore)
 {
     sei();
-    *semaphore = *semaphore + 1;
+
+    TRACE_EVENT(TRACE_EVENT_SEM_POST, Trace_CurrentSlot(), TRACE_OBJECT(semaphore));
+
+    if (wakeFromList(&semaphore->waiters, 0) == NULL && semaphore->count < semaphore->maxCount)
+    {
+        semaphore->count = semaphore->count + 1;
+        QUEUE_SET_NOTIFY(&semaphore->setLink);
+    }
+
     cli();
 }
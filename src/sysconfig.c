@@ -0,0 +1,79 @@
+/******************************************************************************
+ * [File Name]:     sysconfig.c
+ *
+ * [Description]:   Static System Configuration Source File.
+ *                  Creates every kernel object of a system description by
+ *                  walking its const tables, on storage the generator sized
+ *                  statically. Nothing is allocated and no table is copied.
+ *                  Objects are created before threads, so a thread preempting
+ *                  SysConfig_Init finds them ready.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "sysconfig.h"
+
+
+/******************************************************************************
+ *
+ * [Function Name]: SysConfig_Init
+ *
+ * [Description]:   Creates the queues, semaphores, timers and threads of a
+ *                  system description, normally g_System generated by
+ *                  tools/jarvis_config.py. Call it before JARVIS_initKernel.
+ *
+ * [Arguments]:     const SysConfig_System *system
+ * [Return]:        uint8_t, SYSCONFIG_SUCCESS or the kind of object that
+ *                  couldn't be created
+ *
+ *****************************************************************************/
+uint8_t SysConfig_Init (const SysConfig_System *system)
+{
+    uint32_t Idx;
+
+    for (Idx = 0 ; Idx < system->queueCount ; Idx++)
+    {
+        const SysConfig_Queue *queue = &system->queues[Idx];
+
+        *queue->handle = QueueCreateStatic(queue->length, queue->size, queue->queue, queue->storage);
+        if (*queue->handle == NULL)
+            return ERROR_SYSCONFIG_QUEUE;
+    }
+
+    for (Idx = 0 ; Idx < system->semaphoreCount ; Idx++)
+    {
+        const SysConfig_Semaphore *semaphore = &system->semaphores[Idx];
+
+        if (semaphore->binary)
+            SemaphoreCreateBinary(semaphore->semaphore);
+        else
+            SemaphoreCreate(semaphore->semaphore, semaphore->tokens);
+
+        semaphore->semaphore->count = semaphore->tokens;    /* A binary semaphore may start taken */
+    }
+
+#if (SOFTWARE_TIMERS == 1)
+    for (Idx = 0 ; Idx < system->timerCount ; Idx++)
+    {
+        const SysConfig_Timer *timer = &system->timers[Idx];
+
+        if (TimerCreate(timer->timer, timer->period, timer->mode, timer->callback, NULL) != TIMER_SUCCESS)
+            return ERROR_SYSCONFIG_TIMER;
+
+        if (timer->start)
+            TimerStart(timer->timer);
+    }
+#endif
+
+    for (Idx = 0 ; Idx < system->threadCount ; Idx++)
+    {
+        const SysConfig_Thread *thread = &system->threads[Idx];
+
+        *thread->handle = ThreadCreateStatic(thread->name, thread->entry, thread->priority,
+                                             thread->stack, thread->stackSize);
+        if (*thread->handle == NULL)
+            return ERROR_SYSCONFIG_THREAD;
+    }
+
+    return SYSCONFIG_SUCCESS;
+}
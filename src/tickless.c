@@ -0,0 +1,76 @@
+/******************************************************************************
+ *
+ * [File Name]:     tickless.c
+ *
+ * [Description]:   Tickless Idle Tick Compensation Source File.
+ *                  Pure arithmetic with no hardware access, so it can be
+ *                  compiled and checked on the host.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#include "tickless.h"
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Tickless_sleepCycles
+ *
+ * [Description]:   Computes how many SysTick cycles to sleep so the counter
+ *                  expires exactly on the idleTicks-th tick boundary from now.
+ *                  The first boundary is currentCycles away, the rest are one
+ *                  tick apart. Saturates instead of overflowing 32 bits.
+ *
+ * [Arguments]:     uint32_t currentCycles, uint32_t cyclesPerTick,
+ *                  uint32_t idleTicks
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+uint32_t Tickless_sleepCycles (uint32_t currentCycles, uint32_t cyclesPerTick, uint32_t idleTicks)
+{
+    uint32_t maxTicks;
+
+    if (idleTicks == 0)
+        return 0;
+
+    maxTicks = (0xFFFFFFFF - currentCycles) / cyclesPerTick;
+
+    if (idleTicks - 1 > maxTicks)                           /* Clip to the longest sleep that fits in 32 bits */
+        idleTicks = maxTicks + 1;
+
+    return currentCycles + (idleTicks - 1) * cyclesPerTick;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Tickless_compensate
+ *
+ * [Description]:   Converts the cycles actually slept into the number of tick
+ *                  boundaries that were crossed, and the cycles left until the
+ *                  next boundary so the tick phase is kept.
+ *
+ * [Arguments]:     uint32_t currentCycles, uint32_t cyclesPerTick,
+ *                  uint32_t elapsedCycles
+ * [Return]:        Tickless_Compensation
+ *
+ *****************************************************************************/
+Tickless_Compensation Tickless_compensate (uint32_t currentCycles, uint32_t cyclesPerTick, uint32_t elapsedCycles)
+{
+    Tickless_Compensation result;
+    uint32_t afterFirst;
+
+    if (elapsedCycles < currentCycles)                      /* Woken before the first boundary */
+    {
+        result.ticks = 0;
+        result.nextTickCycles = currentCycles - elapsedCycles;
+    }
+    else
+    {
+        afterFirst = elapsedCycles - currentCycles;
+        result.ticks = 1 + (afterFirst / cyclesPerTick);
+        result.nextTickCycles = cyclesPerTick - (afterFirst % cyclesPerTick);
+    }
+    return result;
+}
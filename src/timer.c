@@ -0,0 +1,303 @@
+/******************************************************************************
+ * [File Name]:     timer.c
+ *
+ * [Description]:   Software Timers Implementation Source File.
+ *                  Active timers are kept in a list sorted by expiry tick. A
+ *                  single daemon thread pends until the head expires, then runs
+ *                  the callbacks of every expired timer, so all timers share
+ *                  one TCB and one stack. The timer APIs edit the list in a
+ *                  critical section and wake the daemon when the head changes.
+ *                  Callbacks run at TIMER_DAEMON_PRIORITY and must not block
+ *                  for long, the next timers would be late.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "timer.h"
+
+#if (SOFTWARE_TIMERS == 1)
+
+/*******************************************************************************
+ *                          Global Variables
+ ******************************************************************************/
+/* Active timers, earliest expiry first */
+static TimerHandle_t *g_TimerList = NULL;
+
+/* The daemon pends here until the head expires or changes */
+static WaitList g_TimerDaemonWait;
+
+static ThreadHandle_t g_TimerDaemon = NULL;
+static int32_t g_TimerStack[TIMER_DAEMON_STACK_SIZE];
+
+
+/******************************************************************************
+ *
+ * [Function Name]: timerListInsert
+ *
+ * [Description]:   Inserts a timer behind every timer expiring at the same tick
+ *                  or earlier, and wakes the daemon when it becomes the head.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TimerHandle_t *timer
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void timerListInsert (TimerHandle_t *timer)
+{
+    TimerHandle_t **link = &g_TimerList;
+    uint32_t now = JARVIS_GetTicks();
+
+    while (*link != NULL && (int32_t)((*link)->expiry - now) <= (int32_t)(timer->expiry - now))
+        link = &(*link)->next;
+
+    timer->next = *link;
+    *link = timer;
+    timer->active = 1;
+
+    if (g_TimerList == timer)                               /* Daemon is waiting for a later expiry */
+        wakeFromList(&g_TimerDaemonWait, 0);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: timerListRemove
+ *
+ * [Description]:   Unlinks an active timer. If it was the head, the daemon
+ *                  just wakes up once for nothing.
+ *                  Must be called with interrupts disabled.
+ *
+ * [Arguments]:     TimerHandle_t *timer
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void timerListRemove (TimerHandle_t *timer)
+{
+    TimerHandle_t **link = &g_TimerList;
+
+    if (!timer->active)
+        return;
+
+    while (*link != NULL && *link != timer)
+        link = &(*link)->next;
+
+    if (*link != NULL)
+        *link = timer->next;
+
+    timer->next = NULL;
+    timer->active = 0;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: timerDaemon
+ *
+ * [Description]:   Timer daemon thread. Runs the callback of each expired
+ *                  timer, reloading auto-reload timers from their previous
+ *                  expiry so they don't drift, then pends until the next one.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void timerDaemon (void)
+{
+    TimerHandle_t *timer;
+    uint32_t now;
+
+    while (1)
+    {
+        sei();
+
+        now = JARVIS_GetTicks();
+        timer = g_TimerList;
+
+        if (timer != NULL && TICK_REACHED(now, timer->expiry))
+        {
+            timerListRemove(timer);
+
+            if (timer->mode == TIMER_AUTO_RELOAD)
+            {
+                timer->expiry += timer->period;
+                timerListInsert(timer);
+            }
+
+            cli();
+
+            timer->callback(timer);                         /* Outside the critical section, it may use any API */
+        }
+        else
+        {
+            waitOnList(&g_TimerDaemonWait, (timer == NULL) ? WAIT_FOREVER : timer->expiry - now);
+            cli();
+        }
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: TimerCreate
+ *
+ * [Description]:   Creates a stopped timer expiring every period ticks. A
+ *                  timer created again while running is stopped first. The
+ *                  first timer created also creates the daemon thread, which
+ *                  takes one of the NUM_OF_THREADS TCBs.
+ *
+ * [Arguments]:     TimerHandle_t *timer, uint32_t period, uint8_t mode,
+ *                  void(*callback)(TimerHandle_t *timer), void *argument
+ * [Return]:        uint8_t, TIMER_SUCCESS, ERROR_TIMER_INVALID for a 0 period or
+ *                  no callback, ERROR_TIMER_DAEMON if no TCB is left for the daemon
+ *
+ *****************************************************************************/
+uint8_t TimerCreate (TimerHandle_t *timer, uint32_t period, uint8_t mode,
+                     void(*callback)(TimerHandle_t *timer), void *argument)
+{
+    if (period == 0 || callback == NULL)
+        return ERROR_TIMER_INVALID;
+
+    sei();
+
+    if (g_TimerDaemon == NULL)                              /* Two first callers mustn't both create it */
+    {
+        waitListInit(&g_TimerDaemonWait);
+        g_TimerDaemon = ThreadCreateStatic((const uint8_t *)"TimerDaemon", timerDaemon, TIMER_DAEMON_PRIORITY,
+                                           g_TimerStack, TIMER_DAEMON_STACK_SIZE);
+
+        if (g_TimerDaemon == NULL)
+        {
+            cli();
+            return ERROR_TIMER_DAEMON;
+        }
+    }
+
+    timerListRemove(timer);                                 /* Only unlinks it if it's in the list */
+
+    timer->next = NULL;
+    timer->expiry = 0;
+    timer->period = period;
+    timer->mode = mode;
+    timer->active = 0;
+    timer->callback = callback;
+    timer->argument = argument;
+
+    cli();
+
+    return TIMER_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: TimerStart
+ *
+ * [Description]:   Starts a stopped timer, it expires period ticks from now.
+ *                  No effect on a running timer. ISR safe.
+ *
+ * [Arguments]:     TimerHandle_t *timer
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void TimerStart (TimerHandle_t *timer)
+{
+    sei();
+
+    if (!timer->active)
+    {
+        timer->expiry = JARVIS_GetTicks() + timer->period;
+        timerListInsert(timer);
+    }
+
+    cli();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: TimerStop
+ *
+ * [Description]:   Stops a timer, its callback isn't called anymore unless the
+ *                  daemon is already running it. ISR safe.
+ *
+ * [Arguments]:     TimerHandle_t *timer
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void TimerStop (TimerHandle_t *timer)
+{
+    sei();
+    timerListRemove(timer);
+    cli();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: TimerReset
+ *
+ * [Description]:   Restarts a timer, running or stopped, so it expires period
+ *                  ticks from now (e.g. a watchdog kicked on activity). ISR safe.
+ *
+ * [Arguments]:     TimerHandle_t *timer
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void TimerReset (TimerHandle_t *timer)
+{
+    sei();
+
+    timerListRemove(timer);
+    timer->expiry = JARVIS_GetTicks() + timer->period;
+    timerListInsert(timer);
+
+    cli();
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: TimerChangePeriod
+ *
+ * [Description]:   Sets a new period and restarts the timer from now with it.
+ *                  ISR safe.
+ *
+ * [Arguments]:     TimerHandle_t *timer, uint32_t period
+ * [Return]:        uint8_t, TIMER_SUCCESS or ERROR_TIMER_INVALID for a 0 period
+ *
+ *****************************************************************************/
+uint8_t TimerChangePeriod (TimerHandle_t *timer, uint32_t period)
+{
+    if (period == 0)
+        return ERROR_TIMER_INVALID;
+
+    sei();
+
+    timerListRemove(timer);
+    timer->period = period;
+    timer->expiry = JARVIS_GetTicks() + period;
+    timerListInsert(timer);
+
+    cli();
+
+    return TIMER_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: TimerIsActive
+ *
+ * [Description]:   Tells whether a timer is running. A one-shot timer stops
+ *                  right before its callback is called.
+ *
+ * [Arguments]:     TimerHandle_t *timer
+ * [Return]:        uint8_t, 1 if running
+ *
+ *****************************************************************************/
+uint8_t TimerIsActive (TimerHandle_t *timer)
+{
+    return timer->active;
+}
+
+#endif
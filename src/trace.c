@@ -0,0 +1,124 @@
+/******************************************************************************
+ * [File Name]:     trace.c
+ *
+ * [Description]:   Kernel Event Trace Buffer Source File.
+ *                  Events are 12-byte timestamped records written to a RAM ring
+ *                  that keeps the last TRACE_BUFFER_SIZE of them. Writers claim
+ *                  a record with LDREX / STREX, so threads and ISRs of any
+ *                  priority record without disabling interrupts. Nothing reads
+ *                  the ring on the target: halt it, dump g_Trace and decode it
+ *                  with tools/jarvis_trace2json.py.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include "trace.h"
+#include "JarvisOS_kernel.h"
+
+#if (TRACE_ENABLE == 1)
+
+/*******************************************************************************
+ *                          Global Variables
+ ******************************************************************************/
+/* Layout described in the header so the host tool can decode a raw dump */
+Trace_Buffer g_Trace = {
+    .magic      = TRACE_MAGIC,
+    .version    = TRACE_VERSION,
+    .recordSize = sizeof(Trace_Entry),
+    .clockHz    = PORT_TIMESTAMP_HZ,
+    .length     = TRACE_BUFFER_SIZE,
+    .threads    = NUM_OF_THREADS+1,
+    .nameLength = THREAD_ID_MAX_LENGTH
+};
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Trace_Record
+ *
+ * [Description]:   Records one event, overwriting the oldest record when the
+ *                  ring is full. ISR safe.
+ *
+ * [Arguments]:     uint8_t event, uint8_t slot, uint16_t arg
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void Trace_Record (uint8_t event, uint8_t slot, uint16_t arg)
+{
+    uint32_t timestamp = PORT_TIMESTAMP();
+    uint32_t position;
+    Trace_Entry *record;
+
+    do
+    {
+        position = g_Trace.head;
+    } while (!Port_CompareAndSwap(&g_Trace.head, position, position + 1));
+
+    record = &g_Trace.records[position & (TRACE_BUFFER_SIZE - 1)];
+    record->timestamp = timestamp;
+    record->event = event;
+    record->thread = slot;
+    record->arg = arg;
+    PORT_DMB();                                             /* Fields before the marker that validates them */
+    record->sequence = position + 1;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Trace_ThreadName
+ *
+ * [Description]:   Stores the name of the thread in a TCB slot, so the host
+ *                  tool can label its track.
+ *
+ * [Arguments]:     uint8_t slot, const uint8_t *name
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void Trace_ThreadName (uint8_t slot, const uint8_t *name)
+{
+    if (slot <= NUM_OF_THREADS)
+        strncpy(g_Trace.names[slot], name, THREAD_ID_MAX_LENGTH);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Trace_CurrentSlot
+ *
+ * [Description]:   TCB slot of the running thread, 0xFF before the kernel runs.
+ *
+ * [Arguments]:     void
+ * [Return]:        uint8_t
+ *
+ *****************************************************************************/
+uint8_t Trace_CurrentSlot (void)
+{
+    if (g_curr_running_thread == NULL)
+        return 0xFF;
+
+    return g_curr_running_thread->slot;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Trace_Clear
+ *
+ * [Description]:   Drops every record, e.g. to trace only a region of interest.
+ *                  The markers are cleared too, as the positions start over.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+void Trace_Clear (void)
+{
+    uint32_t Idx;
+
+    for (Idx = 0 ; Idx < TRACE_BUFFER_SIZE ; Idx++)
+        g_Trace.records[Idx].sequence = 0;
+    g_Trace.head = 0;
+}
+
+#endif
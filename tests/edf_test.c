@@ -0,0 +1,186 @@
+/******************************************************************************
+ * [File Name]:     edf_test.c
+ *
+ * [Description]:   Host test of the EDF band on the POSIX port. Two periodic
+ *                  threads with deadlines equal to their periods, (C=2, T=5)
+ *                  and (C=4, T=7) ticks, would load the CPU to 97 %; each job
+ *                  spends WORK_PERCENT of its C, the rest absorbs the tick
+ *                  handling. Fixed priorities miss deadlines with this set
+ *                  whichever thread goes first; EDF must meet every one. Runs
+ *                  RUN_TICKS ticks, then checks no deadline was missed and
+ *                  every job was completed. The tick counts CPU time
+ *                  (PORT_POSIX_TICK_CPU), so host stalls don't cause misses.
+ *                  Exits with 0 on pass.
+ *
+ *                  gcc -std=gnu99 -fno-builtin -DJARVIS_PORT_POSIX -DEDF_SCHEDULING=1 -DPORT_POSIX_TICK_US=10000
+ *                      -DPORT_POSIX_TICK_CPU=1 -Iinc <kernel sources> tests/edf_test.c -o edf_test
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "jarvis_test.h"
+#include "JarvisOS_kernel.h"
+
+#if (EDF_SCHEDULING != 1)
+#error "edf_test: build with -DEDF_SCHEDULING=1"
+#endif
+
+#if (PORT_POSIX_TICK_CPU != 1)
+#error "edf_test: build with -DPORT_POSIX_TICK_CPU=1"
+#endif
+
+#if (NUM_OF_THREADS < 3)
+#error "edf_test: needs NUM_OF_THREADS of at least 3"
+#endif
+
+#define WORK_PERCENT            95          /* Share of each C really spent */
+#define RUN_TICKS               350         /* 10 hyperperiods of 35 ticks */
+#define CALIBRATION_LOOPS       20000000
+
+typedef struct{
+    uint32_t        cost;                   /* C, ticks of work per job */
+    uint32_t        period;                 /* T, also the relative deadline */
+    ThreadHandle_t  handle;
+    volatile uint32_t jobs;
+}Task;
+
+static Task g_Tasks[2] = {{2, 5, NULL, 0}, {4, 7, NULL, 0}};
+
+static uint64_t g_LoopsPerTick;
+static volatile uint32_t g_Sink;
+
+
+/******************************************************************************
+ *
+ * [Function Name]: busyLoops
+ *
+ * [Description]:   Burns the CPU for a number of loop iterations.
+ *
+ * [Arguments]:     uint64_t loops
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void busyLoops (uint64_t loops)
+{
+    uint64_t Idx;
+
+    for (Idx = 0 ; Idx < loops ; Idx++)
+        g_Sink = g_Sink + (uint32_t)Idx;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: calibrate
+ *
+ * [Description]:   Measures how many busy loops fit in one tick of CPU time.
+ *                  The fastest of three runs is kept, so jobs never need less
+ *                  than their C.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void calibrate (void)
+{
+    struct timespec start, end;
+    uint64_t elapsedUs, best = 0;
+    uint8_t run;
+
+    for (run = 0 ; run < 3 ; run++)
+    {
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
+        busyLoops(CALIBRATION_LOOPS);
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &end);
+
+        elapsedUs = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000u + (end.tv_nsec - start.tv_nsec) / 1000;
+        if (elapsedUs == 0)
+            elapsedUs = 1;
+
+        if ((uint64_t)CALIBRATION_LOOPS * PORT_POSIX_TICK_US / elapsedUs > best)
+            best = (uint64_t)CALIBRATION_LOOPS * PORT_POSIX_TICK_US / elapsedUs;
+    }
+
+    g_LoopsPerTick = best;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: periodicThread
+ *
+ * [Description]:   Runs the jobs of one task: C ticks of work, then waits for
+ *                  the next release.
+ *
+ * [Arguments]:     Task *task
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void periodicThread (Task *task)
+{
+    while (1)
+    {
+        busyLoops(g_LoopsPerTick * task->cost * WORK_PERCENT / 100);
+        task->jobs++;
+        Thread_WaitNextPeriod();
+    }
+}
+
+static void Task0_Thread (void) { periodicThread(&g_Tasks[0]); }
+static void Task1_Thread (void) { periodicThread(&g_Tasks[1]); }
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Check_Thread
+ *
+ * [Description]:   Highest priority thread, wakes after RUN_TICKS and checks
+ *                  the outcome, then ends the simulation.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void Check_Thread (void)
+{
+    uint32_t misses, expected;
+    uint8_t Idx;
+
+    Thread_Suspend(RUN_TICKS);
+
+    for (Idx = 0 ; Idx < 2 ; Idx++)
+    {
+        misses = Thread_GetDeadlineMisses(g_Tasks[Idx].handle);
+        expected = RUN_TICKS / g_Tasks[Idx].period;
+
+        printf("task (C=%u, T=%u): %u jobs, %u deadline misses\n",
+               g_Tasks[Idx].cost, g_Tasks[Idx].period, g_Tasks[Idx].jobs, misses);
+
+        CHECK(misses == 0, "task %u missed %u deadlines", Idx, misses);
+        CHECK(g_Tasks[Idx].jobs + 1 >= expected, "task %u completed %u jobs of %u", Idx, g_Tasks[Idx].jobs, expected);
+    }
+
+    exit(testResult("edf_test"));
+}
+
+
+int main (void)
+{
+    calibrate();
+
+    printf("utilization %u %%, %llu loops per tick\n",
+           (100 * WORK_PERCENT * (2 * 7 + 4 * 5)) / (100 * 35), (unsigned long long)g_LoopsPerTick);
+
+    ThreadCreate((const uint8_t *)"Check", Check_Thread, EDF_PRIORITY + 1, 0);
+    g_Tasks[0].handle = ThreadCreate((const uint8_t *)"Task0", Task0_Thread, EDF_PRIORITY, 0);
+    g_Tasks[1].handle = ThreadCreate((const uint8_t *)"Task1", Task1_Thread, EDF_PRIORITY, 0);
+
+    Thread_SetDeadline(g_Tasks[0].handle, g_Tasks[0].period, g_Tasks[0].period);
+    Thread_SetDeadline(g_Tasks[1].handle, g_Tasks[1].period, g_Tasks[1].period);
+
+    JARVIS_initKernel();
+    return 1;
+}
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * [File Name]:     fairness_test.c
+ *
+ * [Description]:   Host test of the weighted round-robin among threads of the
+ *                  same priority, on the POSIX port. Two busy threads with
+ *                  time slice weights of 1 and 3 count as fast as they can
+ *                  for RUN_TICKS ticks; their counters must end 1:3 apart,
+ *                  within RATIO_TOLERANCE. The tick counts CPU time
+ *                  (PORT_POSIX_TICK_CPU), so host stalls don't skew the shares.
+ *                  Exits with 0 on pass.
+ *
+ *                  gcc -std=gnu99 -fno-builtin -DJARVIS_PORT_POSIX -DPORT_POSIX_TICK_CPU=1
+ *                      -Iinc <kernel sources> tests/fairness_test.c -o fairness_test
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "jarvis_test.h"
+#include "JarvisOS_kernel.h"
+
+#if (PORT_POSIX_TICK_CPU != 1)
+#error "fairness_test: build with -DPORT_POSIX_TICK_CPU=1"
+#endif
+
+#if (NUM_OF_THREADS < 3)
+#error "fairness_test: needs NUM_OF_THREADS of at least 3"
+#endif
+
+#define WORKER_PRIORITY         1
+#define RUN_TICKS               2000        /* 500 rounds of 1 + 3 slices */
+#define RATIO_PERCENT           300         /* Expected share of the weight 3 thread, in % of the weight 1 one */
+#define RATIO_TOLERANCE         5           /* Accepted deviation, in % of RATIO_PERCENT itself: 2.85 to 3.15 */
+
+static volatile uint64_t g_Counters[2];
+
+
+static void Light_Thread (void) { while (1) g_Counters[0]++; }
+static void Heavy_Thread (void) { while (1) g_Counters[1]++; }
+
+
+/******************************************************************************
+ *
+ * [Function Name]: Check_Thread
+ *
+ * [Description]:   Highest priority thread, wakes after RUN_TICKS and checks
+ *                  the counters' ratio, then ends the simulation.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void Check_Thread (void)
+{
+    uint64_t light, heavy, ratio;
+
+    Thread_Suspend(RUN_TICKS);
+
+    light = g_Counters[0];
+    heavy = g_Counters[1];
+    ratio = light ? heavy * 100 / light : 0;
+
+    printf("weight 1: %llu, weight 3: %llu, ratio %llu.%02llu\n",
+           (unsigned long long)light, (unsigned long long)heavy,
+           (unsigned long long)(ratio / 100), (unsigned long long)(ratio % 100));
+
+    CHECK(light != 0, "weight 1 thread never ran");
+    CHECK(ratio * 100 >= (uint64_t)RATIO_PERCENT * (100 - RATIO_TOLERANCE) &&
+          ratio * 100 <= (uint64_t)RATIO_PERCENT * (100 + RATIO_TOLERANCE),
+          "ratio %llu%% outside %u%% +/- %u%%", (unsigned long long)ratio, RATIO_PERCENT, RATIO_TOLERANCE);
+
+    exit(testResult("fairness_test"));
+}
+
+
+int main (void)
+{
+    ThreadHandle_t heavy;
+
+    ThreadCreate((const uint8_t *)"Check", Check_Thread, WORKER_PRIORITY + 1, 0);
+    ThreadCreate((const uint8_t *)"Light", Light_Thread, WORKER_PRIORITY, 0);
+    heavy = ThreadCreate((const uint8_t *)"Heavy", Heavy_Thread, WORKER_PRIORITY, 0);
+
+    Thread_SetTimeSlice(heavy, 3);
+
+    JARVIS_initKernel();
+    return 1;
+}
@@ -0,0 +1,221 @@
+/******************************************************************************
+ * [File Name]:     heap_bench.c
+ *
+ * [Description]:   Host randomized test and benchmark of the TLSF kernel heap
+ *                  (heap.c). Allocates and frees random sizes in a random order,
+ *                  fills every block with a pattern and checks it's intact when
+ *                  freed, so overlapping blocks are caught. Checks that
+ *                  HeapGetStats' largestFreeBlock can be allocated and one byte
+ *                  more can't, and that the heap is whole again once everything
+ *                  is freed. Prints the average and worst time per call.
+ *                  Exits with 0 on pass.
+ *
+ *                  gcc -std=gnu99 -O2 -Wall -fno-builtin -DJARVIS_PORT_POSIX -Iinc src/heap.c tests/heap_bench.c -o heap_bench
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "jarvis_test.h"
+#include "heap.h"
+
+#define LIVE_SLOTS              32
+#define OPERATIONS              2000000
+#define STATS_EVERY             1000
+#define MAX_SMALL_REQUEST       256
+#define LARGE_REQUEST_ODDS      16          /* One request in 16 may be up to HEAP_SIZE / 4 */
+
+typedef struct{
+    uint8_t         *ptr;
+    uint32_t        size;
+    uint8_t         pattern;
+}Allocation;
+
+typedef struct{
+    uint64_t        calls;
+    uint64_t        totalNs;
+    uint64_t        worstNs;
+}Timing;
+
+
+/* The heap only needs its critical section to nest, nothing preempts this test */
+void sei (void) {}
+void cli (void) {}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: randomNext
+ *
+ * [Description]:   xorshift32, repeatable pseudo random numbers.
+ *
+ * [Arguments]:     void
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+static uint32_t randomNext (void)
+{
+    static uint32_t state = 0x9E3779B9;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: nowNs
+ *
+ * [Description]:   Monotonic time in nanoseconds.
+ *
+ * [Arguments]:     void
+ * [Return]:        uint64_t
+ *
+ *****************************************************************************/
+static uint64_t nowNs (void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: timingAdd
+ *
+ * [Description]:   Accounts one timed call.
+ *
+ * [Arguments]:     Timing *timing, uint64_t start
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void timingAdd (Timing *timing, uint64_t start)
+{
+    uint64_t elapsed = nowNs() - start;
+
+    timing->calls++;
+    timing->totalNs += elapsed;
+    if (elapsed > timing->worstNs)
+        timing->worstNs = elapsed;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: checkLargest
+ *
+ * [Description]:   largestFreeBlock must be allocatable, one byte more mustn't.
+ *                  Leaves the heap as it found it.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void checkLargest (void)
+{
+    HeapStats_t stats;
+    void *ptr;
+
+    HeapGetStats(&stats);
+
+    CHECK(stats.freeBytes <= stats.totalBytes, "free %u above total %u", stats.freeBytes, stats.totalBytes);
+    CHECK(stats.largestFreeBlock <= stats.freeBytes, "largest %u above free %u", stats.largestFreeBlock, stats.freeBytes);
+
+    if (stats.largestFreeBlock == 0)
+        return;
+
+    ptr = HeapAlloc(stats.largestFreeBlock);
+    CHECK(ptr != NULL, "HeapAlloc(largestFreeBlock = %u) failed", stats.largestFreeBlock);
+    HeapFree(ptr);
+
+    ptr = HeapAlloc(stats.largestFreeBlock + 1);
+    CHECK(ptr == NULL, "HeapAlloc(largestFreeBlock + 1 = %u) succeeded", stats.largestFreeBlock + 1);
+    HeapFree(ptr);
+}
+
+
+int main (void)
+{
+    static Allocation live[LIVE_SLOTS];
+    Allocation *slot;
+    Timing allocTiming = {0, 0, 0}, freeTiming = {0, 0, 0};
+    HeapStats_t stats;
+    uint32_t failedAllocs = 0;
+    uint32_t operation, Idx;
+    uint64_t start;
+
+    for (operation = 0 ; operation < OPERATIONS && g_Failures == 0 ; operation++)
+    {
+        slot = &live[randomNext() % LIVE_SLOTS];
+
+        if (slot->ptr == NULL)
+        {
+            if (randomNext() % LARGE_REQUEST_ODDS == 0)
+                slot->size = 1 + randomNext() % (HEAP_SIZE / 4);
+            else
+                slot->size = 1 + randomNext() % MAX_SMALL_REQUEST;
+
+            start = nowNs();
+            slot->ptr = (uint8_t *)HeapAlloc(slot->size);
+            timingAdd(&allocTiming, start);
+
+            if (slot->ptr == NULL)
+            {
+                failedAllocs++;
+                continue;
+            }
+
+            CHECK(((uintptr_t)slot->ptr & (HEAP_ALIGN - 1)) == 0, "%p isn't %u bytes aligned", (void *)slot->ptr, HEAP_ALIGN);
+
+            slot->pattern = (uint8_t)randomNext();
+            for (Idx = 0 ; Idx < slot->size ; Idx++)
+                slot->ptr[Idx] = (uint8_t)(slot->pattern + Idx);
+        }
+        else
+        {
+            for (Idx = 0 ; Idx < slot->size ; Idx++)
+            {
+                if (slot->ptr[Idx] != (uint8_t)(slot->pattern + Idx))
+                {
+                    CHECK(0, "block %p of %u bytes overwritten at %u", (void *)slot->ptr, slot->size, Idx);
+                    break;
+                }
+            }
+
+            start = nowNs();
+            HeapFree(slot->ptr);
+            timingAdd(&freeTiming, start);
+
+            slot->ptr = NULL;
+        }
+
+        if (operation % STATS_EVERY == 0)
+            checkLargest();
+    }
+
+    for (Idx = 0 ; Idx < LIVE_SLOTS ; Idx++)
+        HeapFree(live[Idx].ptr);
+
+    HeapGetStats(&stats);
+    CHECK(stats.freeBytes == stats.totalBytes, "%u of %u bytes free after freeing everything", stats.freeBytes, stats.totalBytes);
+    CHECK(stats.fragmentation == 0, "fragmentation %u%% on an empty heap", stats.fragmentation);
+    checkLargest();
+
+    printf("HeapAlloc: %llu calls (%u found no block), average %llu ns, worst %llu ns\n",
+           (unsigned long long)allocTiming.calls, failedAllocs,
+           (unsigned long long)(allocTiming.totalNs / (allocTiming.calls ? allocTiming.calls : 1)),
+           (unsigned long long)allocTiming.worstNs);
+    printf("HeapFree:  %llu calls, average %llu ns, worst %llu ns\n",
+           (unsigned long long)freeTiming.calls,
+           (unsigned long long)(freeTiming.totalNs / (freeTiming.calls ? freeTiming.calls : 1)),
+           (unsigned long long)freeTiming.worstNs);
+    printf("High water mark: %u of %u bytes\n", stats.highWaterMark, stats.totalBytes);
+
+    return testResult("heap_bench");
+}
@@ -0,0 +1,60 @@
+/******************************************************************************
+ * [File Name]:     jarvis_test.h
+ *
+ * [Description]:   Shared checks of the host tests. CHECK counts a failed
+ *                  condition and prints the first TEST_MAX_REPORTS of them;
+ *                  testResult prints the verdict and gives the exit status.
+ *                  Include it from exactly one file per test program.
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+
+#ifndef _JARVIS_TEST_H
+#define _JARVIS_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Failed checks reported in full, later ones are only counted */
+#define TEST_MAX_REPORTS        20
+
+static uint32_t g_Failures = 0;
+
+#define CHECK(condition, ...)                                       \
+    do {                                                            \
+        if (!(condition))                                           \
+        {                                                           \
+            if (g_Failures++ < TEST_MAX_REPORTS)                    \
+            {                                                       \
+                printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+                printf(__VA_ARGS__);                                \
+                printf("\n");                                       \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+
+/******************************************************************************
+ *
+ * [Function Name]: testResult
+ *
+ * [Description]:   Prints "<name>: PASS", or how many checks failed.
+ *
+ * [Arguments]:     const char *name
+ * [Return]:        int, 0 on pass, 1 otherwise, the test's exit status
+ *
+ *****************************************************************************/
+static int testResult (const char *name)
+{
+    if (g_Failures != 0)
+    {
+        printf("%s: %lu checks FAILED\n", name, (unsigned long)g_Failures);
+        return 1;
+    }
+
+    printf("%s: PASS\n", name);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,258 @@
+/******************************************************************************
+ * [File Name]:     msgbuffer_test.c
+ *
+ * [Description]:   Host test of the message buffer (msgbuffer.c) on the POSIX
+ *                  port, deleting threads in the middle of a copy. A sender
+ *                  streaming MESSAGE_LENGTH bytes messages is deleted while it
+ *                  holds a reservation: every message already sent must still
+ *                  arrive intact, the dropped one must free its space, and a
+ *                  new sender must get through. Then a receiver is deleted
+ *                  while copying a message out: the message must be left for
+ *                  the next receiver. Exits with 0 on pass.
+ *
+ *                  gcc -std=gnu99 -fno-builtin -DJARVIS_PORT_POSIX -Iinc <kernel sources>
+ *                      tests/msgbuffer_test.c -o msgbuffer_test
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "jarvis_test.h"
+#include "JarvisOS_kernel.h"
+#include "msgbuffer.h"
+
+#if (NUM_OF_THREADS < 3)
+#error "msgbuffer_test: needs NUM_OF_THREADS of at least 3"
+#endif
+
+#define MESSAGE_LENGTH          MSGBUF_MAX_MESSAGE  /* Long copies, so a tick often lands inside one */
+#define BUFFER_MESSAGES         3
+#define CATCH_TICKS             5000        /* Give up catching a thread mid-copy after this long */
+#define AFTER_MESSAGES          20          /* Sent by the second sender */
+
+static MsgBufferHandle_t g_Buffer;
+static uint8_t g_Storage[MSGBUF_STORAGE_SIZE(BUFFER_MESSAGES, MESSAGE_LENGTH)];
+static uint8_t g_SendMessage[MESSAGE_LENGTH];
+static uint8_t g_CheckMessage[MESSAGE_LENGTH];
+static uint8_t g_ReceiveMessage[MESSAGE_LENGTH];
+
+static volatile uint32_t g_Sent;            /* Messages the current sender got through */
+static volatile uint32_t g_Received;        /* Messages the receiver thread copied out */
+
+
+/******************************************************************************
+ *
+ * [Function Name]: messageFill
+ *
+ * [Description]:   Writes message number sequence: the number, then a pattern
+ *                  that depends on it.
+ *
+ * [Arguments]:     uint8_t *message, uint32_t sequence
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void messageFill (uint8_t *message, uint32_t sequence)
+{
+    uint32_t Idx;
+
+    message[0] = (uint8_t)sequence;
+    message[1] = (uint8_t)(sequence >> 8);
+    for (Idx = 2 ; Idx < MESSAGE_LENGTH ; Idx++)
+        message[Idx] = (uint8_t)(sequence + Idx);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: messageCheck
+ *
+ * [Description]:   Checks a received message is whole and returns its number.
+ *
+ * [Arguments]:     const uint8_t *message, uint32_t length
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+static uint32_t messageCheck (const uint8_t *message, uint32_t length)
+{
+    uint32_t sequence = (uint32_t)message[0] | ((uint32_t)message[1] << 8);
+    uint32_t Idx;
+
+    CHECK(length == MESSAGE_LENGTH, "message %u is %u bytes long", sequence, length);
+
+    for (Idx = 2 ; Idx < length ; Idx++)
+    {
+        if (message[Idx] != (uint8_t)(sequence + Idx))
+        {
+            CHECK(0, "message %u corrupted at byte %u", sequence, Idx);
+            break;
+        }
+    }
+    return sequence;
+}
+
+
+/* Sends numbered messages until deleted, or count of them */
+static void sendMessages (uint32_t first, uint32_t count)
+{
+    uint32_t sequence;
+
+    for (sequence = first ; sequence < first + count ; sequence++)
+    {
+        messageFill(g_SendMessage, sequence);
+        if (MsgBufferSend(&g_Buffer, g_SendMessage, MESSAGE_LENGTH, WAIT_FOREVER) == MSGBUF_SUCCESS)
+            g_Sent++;
+    }
+}
+
+static void Stream_Thread (void) { sendMessages(0, 0xFFFF); }
+static void After_Thread (void) { sendMessages(0, AFTER_MESSAGES); }
+
+static void Receive_Thread (void)
+{
+    uint32_t length;
+
+    while (1)
+    {
+        if (MsgBufferReceive(&g_Buffer, g_ReceiveMessage, MESSAGE_LENGTH, &length, WAIT_FOREVER) == MSGBUF_SUCCESS)
+            g_Received++;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: drain
+ *
+ * [Description]:   Receives every ready message, checking each one continues
+ *                  the sequence from *next.
+ *
+ * [Arguments]:     uint32_t *next
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void drain (uint32_t *next)
+{
+    uint32_t length, sequence;
+
+    while (MsgBufferReceive(&g_Buffer, g_CheckMessage, MESSAGE_LENGTH, &length, 0) == MSGBUF_SUCCESS)
+    {
+        sequence = messageCheck(g_CheckMessage, length);
+        CHECK(sequence == *next, "received message %u, expected %u", sequence, *next);
+        *next = sequence + 1;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: deleteSender
+ *
+ * [Description]:   Streams messages from a low priority sender and deletes it
+ *                  once a tick finds it holding a reservation, then checks the
+ *                  buffer still works.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void deleteSender (void)
+{
+    ThreadHandle_t sender, after;
+    uint32_t next = 0, ticks, sent;
+
+    sender = ThreadCreate((const uint8_t *)"Stream", Stream_Thread, 1, 0);
+
+    for (ticks = 0 ; ticks < CATCH_TICKS && sender->msgBuffer == NULL ; ticks++)
+    {
+        drain(&next);
+        Thread_Suspend(1);
+    }
+    CHECK(sender->msgBuffer != NULL, "sender never caught mid-send in %u ticks", CATCH_TICKS);
+
+    sent = g_Sent;
+    Thread_Delete(sender);
+    Thread_Suspend(2);                                      /* Lets stateIdle reap it */
+
+    drain(&next);
+    CHECK(next == sent, "%u messages received, %u were sent", next, sent);
+    CHECK(g_Buffer.used == 0, "%u bytes still used after the sender was deleted", g_Buffer.used);
+
+    g_Sent = 0;
+    after = ThreadCreate((const uint8_t *)"After", After_Thread, 1, 0);
+    CHECK(after != NULL, "no thread for the second sender");
+
+    next = 0;
+    for (ticks = 0 ; ticks < CATCH_TICKS && next < AFTER_MESSAGES ; ticks++)
+    {
+        drain(&next);
+        Thread_Suspend(1);
+    }
+    CHECK(next == AFTER_MESSAGES, "second sender got %u of %u messages through", next, AFTER_MESSAGES);
+
+    printf("sender deleted mid-send after %u messages, buffer used %u bytes\n", sent, g_Buffer.used);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: deleteReceiver
+ *
+ * [Description]:   Feeds messages to a low priority receiver and deletes it
+ *                  once a tick finds it copying one out, then checks that
+ *                  message is still there.
+ *
+ * [Arguments]:     void
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void deleteReceiver (void)
+{
+    ThreadHandle_t receiver;
+    uint32_t sequence = 0, ticks, length;
+
+    receiver = ThreadCreate((const uint8_t *)"Receive", Receive_Thread, 1, 0);
+    CHECK(receiver != NULL, "no thread for the receiver");
+
+    for (ticks = 0 ; ticks < CATCH_TICKS && receiver->msgBuffer == NULL ; ticks++)
+    {
+        if (MsgBufferNextLength(&g_Buffer) == 0 && g_Received == sequence)
+        {
+            messageFill(g_SendMessage, ++sequence);
+            MsgBufferSend(&g_Buffer, g_SendMessage, MESSAGE_LENGTH, 0);
+        }
+        Thread_Suspend(1);
+    }
+    CHECK(receiver->msgBuffer != NULL, "receiver never caught mid-receive in %u ticks", CATCH_TICKS);
+
+    Thread_Delete(receiver);
+
+    CHECK(MsgBufferNextLength(&g_Buffer) == MESSAGE_LENGTH, "the message being received was lost");
+    CHECK(MsgBufferReceive(&g_Buffer, g_CheckMessage, MESSAGE_LENGTH, &length, 0) == MSGBUF_SUCCESS,
+          "the message being received can't be received again");
+    CHECK(messageCheck(g_CheckMessage, length) == sequence, "received another message than %u", sequence);
+    CHECK(g_Buffer.used == 0, "%u bytes still used after the receiver was deleted", g_Buffer.used);
+
+    printf("receiver deleted mid-receive of message %u, buffer used %u bytes\n", sequence, g_Buffer.used);
+}
+
+
+static void Check_Thread (void)
+{
+    deleteSender();
+    Thread_Suspend(2);
+    deleteReceiver();
+
+    exit(testResult("msgbuffer_test"));
+}
+
+
+int main (void)
+{
+    MsgBufferCreate(&g_Buffer, g_Storage, sizeof g_Storage);
+
+    ThreadCreate((const uint8_t *)"Check", Check_Thread, 2, 0);
+
+    JARVIS_initKernel();
+    return 1;
+}
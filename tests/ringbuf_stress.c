@@ -0,0 +1,139 @@
+/******************************************************************************
+ * [File Name]:     ringbuf_stress.c
+ *
+ * [Description]:   Host stress test of the lock-free ring buffer (ringbuf.c).
+ *                  POSIX threads stand in for the producers and the consumer,
+ *                  running in parallel on a multi-core host. Every word
+ *                  carries its producer and sequence number, the consumer
+ *                  checks none is lost, duplicated or reordered per producer.
+ *                  Runs RINGBUF_SPSC with one producer, then RINGBUF_MPSC with
+ *                  PRODUCERS of them. Exits with 0 on pass.
+ *
+ *                  gcc -std=gnu99 -O2 -pthread -DJARVIS_PORT_POSIX -Iinc src/ringbuf.c tests/ringbuf_stress.c -o ringbuf_stress
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "jarvis_test.h"
+#include "ringbuf.h"
+
+#define RING_LENGTH             64          /* Small, so producers keep finding it full */
+#define PRODUCERS               4
+#define WORDS_PER_PRODUCER      500000      /* Sequence numbers fit in the low 24 bits */
+
+typedef struct{
+    RingBufHandle_t     *ring;
+    uint32_t            id;
+    uint32_t            fullCount;
+}Producer;
+
+
+/******************************************************************************
+ *
+ * [Function Name]: producerThread
+ *
+ * [Description]:   Writes WORDS_PER_PRODUCER words tagged with the producer id
+ *                  in the top byte, retrying while the ring is full.
+ *
+ * [Arguments]:     void *argument, the Producer
+ * [Return]:        void *
+ *
+ *****************************************************************************/
+static void *producerThread (void *argument)
+{
+    Producer *producer = (Producer *)argument;
+    uint32_t sequence;
+
+    for (sequence = 0 ; sequence < WORDS_PER_PRODUCER ; sequence++)
+    {
+        while (RingBufWrite(producer->ring, (producer->id << 24) | sequence) == ERROR_RINGBUF_FULL)
+        {
+            producer->fullCount++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: runMode
+ *
+ * [Description]:   Starts count producers on a fresh ring and consumes all
+ *                  their words on the calling thread, checking every one.
+ *
+ * [Arguments]:     uint8_t mode, uint32_t count
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void runMode (uint8_t mode, uint32_t count)
+{
+    static RingBuf_Slot slots[RING_LENGTH];
+    RingBufHandle_t ring;
+    Producer producers[PRODUCERS];
+    pthread_t threads[PRODUCERS];
+    uint32_t expected[PRODUCERS] = {0};
+    uint32_t received = 0, emptyCount = 0, fullCount = 0;
+    uint32_t data, id, Idx;
+
+    CHECK(RingBufCreate(&ring, slots, RING_LENGTH, mode) == RINGBUF_SUCCESS, "create mode %u", mode);
+
+    for (Idx = 0 ; Idx < count ; Idx++)
+    {
+        producers[Idx].ring = &ring;
+        producers[Idx].id = Idx;
+        producers[Idx].fullCount = 0;
+        pthread_create(&threads[Idx], NULL, producerThread, &producers[Idx]);
+    }
+
+    while (received < count * WORDS_PER_PRODUCER && g_Failures == 0)
+    {
+        if (RingBufRead(&ring, &data) != RINGBUF_SUCCESS)
+        {
+            emptyCount++;
+            sched_yield();
+            continue;
+        }
+
+        id = data >> 24;
+        CHECK(id < count, "mode %u: word %08x from an unknown producer", mode, data);
+        if (id < count)
+        {
+            CHECK((data & 0xFFFFFF) == expected[id], "mode %u: producer %u sent %u, expected %u",
+                  mode, id, data & 0xFFFFFF, expected[id]);
+            expected[id] = (data & 0xFFFFFF) + 1;
+        }
+        received++;
+    }
+
+    for (Idx = 0 ; Idx < count ; Idx++)
+    {
+        pthread_join(threads[Idx], NULL);
+        fullCount += producers[Idx].fullCount;
+    }
+
+    CHECK(RingBufRead(&ring, &data) == ERROR_RINGBUF_EMPTY, "mode %u: extra word %08x", mode, data);
+    CHECK(RingBufCount(&ring) == 0, "mode %u: count %u after draining", mode, RingBufCount(&ring));
+
+    printf("%s, %u producer(s): %u words, ring found full %u times, empty %u times\n",
+           mode == RINGBUF_SPSC ? "RINGBUF_SPSC" : "RINGBUF_MPSC", count, received, fullCount, emptyCount);
+}
+
+
+int main (void)
+{
+    RingBuf_Slot slots[3];
+    RingBufHandle_t ring;
+
+    CHECK(RingBufCreate(&ring, slots, 3, RINGBUF_SPSC) == ERROR_RINGBUF_LENGTH, "length 3 accepted");
+
+    runMode(RINGBUF_SPSC, 1);
+    runMode(RINGBUF_MPSC, PRODUCERS);
+
+    return testResult("ringbuf_stress");
+}
@@ -0,0 +1,167 @@
+/******************************************************************************
+ * [File Name]:     tickless_test.c
+ *
+ * [Description]:   Host test of the tickless idle arithmetic (tickless.c).
+ *                  Checks Tickless_sleepCycles and Tickless_compensate against
+ *                  a 64-bit reference model, on the 32-bit wrap boundary, at
+ *                  tick boundaries and on random inputs. Exits with 0 on pass.
+ *
+ *                  gcc -std=c99 -Iinc src/tickless.c tests/tickless_test.c -o tickless_test
+ *
+ * [Engineer]:      Hesham Khaled
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include "jarvis_test.h"
+#include "tickless.h"
+
+#define SYSTICK_MAX_CYCLES      0x01000000  /* 24-bit counter */
+#define RANDOM_ROUNDS           1000000
+
+
+/******************************************************************************
+ *
+ * [Function Name]: randomNext
+ *
+ * [Description]:   xorshift32, repeatable pseudo random numbers.
+ *
+ * [Arguments]:     void
+ * [Return]:        uint32_t
+ *
+ *****************************************************************************/
+static uint32_t randomNext (void)
+{
+    static uint32_t state = 0x2545F491;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: checkSleep
+ *
+ * [Description]:   Tickless_sleepCycles must land on the idleTicks-th boundary,
+ *                  or on the last boundary that fits in 32 bits.
+ *
+ * [Arguments]:     uint32_t current, uint32_t perTick, uint32_t idleTicks
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void checkSleep (uint32_t current, uint32_t perTick, uint32_t idleTicks)
+{
+    uint64_t expected = 0;
+    uint32_t got = Tickless_sleepCycles(current, perTick, idleTicks);
+
+    if (idleTicks != 0)
+    {
+        expected = (uint64_t)current + (uint64_t)(idleTicks - 1) * perTick;
+        if (expected > 0xFFFFFFFFu)                         /* Saturated to the last boundary that fits */
+            expected = current + ((0xFFFFFFFFu - current) / perTick) * (uint64_t)perTick;
+    }
+
+    CHECK(got == expected, "sleepCycles(%lu, %lu, %lu) = %lu, expected %llu",
+          (unsigned long)current, (unsigned long)perTick, (unsigned long)idleTicks,
+          (unsigned long)got, (unsigned long long)expected);
+}
+
+
+/******************************************************************************
+ *
+ * [Function Name]: checkCompensate
+ *
+ * [Description]:   Tickless_compensate must count the boundaries crossed within
+ *                  elapsed cycles and the distance to the next one.
+ *
+ * [Arguments]:     uint32_t current, uint32_t perTick, uint32_t elapsed
+ * [Return]:        void
+ *
+ *****************************************************************************/
+static void checkCompensate (uint32_t current, uint32_t perTick, uint32_t elapsed)
+{
+    Tickless_Compensation got = Tickless_compensate(current, perTick, elapsed);
+    uint64_t boundary = current;                            /* First boundary, the rest are perTick apart */
+    uint32_t ticks = 0;
+
+    if (elapsed >= boundary)
+    {
+        ticks = 1 + (uint32_t)((elapsed - boundary) / perTick);
+        boundary += (uint64_t)ticks * perTick;
+    }
+
+    CHECK(got.ticks == ticks && got.nextTickCycles == boundary - elapsed,
+          "compensate(%lu, %lu, %lu) = {%lu, %lu}, expected {%lu, %llu}",
+          (unsigned long)current, (unsigned long)perTick, (unsigned long)elapsed,
+          (unsigned long)got.ticks, (unsigned long)got.nextTickCycles,
+          (unsigned long)ticks, (unsigned long long)(boundary - elapsed));
+}
+
+
+int main (void)
+{
+    const uint32_t perTicks[] = {1, 2, 1000, 1600000, SYSTICK_MAX_CYCLES};
+    uint32_t i, n, current, perTick, ticks, sleep;
+    Tickless_Compensation comp;
+
+    for (i = 0 ; i < sizeof(perTicks) / sizeof(perTicks[0]) ; i++)
+    {
+        perTick = perTicks[i];
+
+        /* Sleep of n ticks wakes exactly on its last boundary, a full tick before the next */
+        for (n = 1 ; n <= 50 ; n++)
+        {
+            current = (perTick > 1) ? perTick - 1 : 1;
+            sleep = Tickless_sleepCycles(current, perTick, n);
+            comp = Tickless_compensate(current, perTick, sleep);
+            CHECK(comp.ticks == n && comp.nextTickCycles == perTick,
+                  "round trip perTick %lu n %lu: {%lu, %lu}", (unsigned long)perTick,
+                  (unsigned long)n, (unsigned long)comp.ticks, (unsigned long)comp.nextTickCycles);
+
+            checkSleep(1, perTick, n);
+            checkSleep(perTick, perTick, n);
+        }
+
+        /* One cycle either side of the first boundaries */
+        for (n = 0 ; n < 4 ; n++)
+        {
+            current = perTick;
+            checkCompensate(current, perTick, current + n * perTick - 1);
+            checkCompensate(current, perTick, current + n * perTick);
+            checkCompensate(current, perTick, current + n * perTick + 1);
+        }
+
+        /* Saturation on the 32-bit wrap boundary */
+        checkSleep(perTick, perTick, 0xFFFFFFFF);
+        checkSleep(perTick, perTick, 0xFFFFFFFF / perTick);
+        checkSleep(perTick, perTick, 0xFFFFFFFF / perTick + 1);
+        checkSleep(perTick, perTick, 0xFFFFFFFF / perTick + 2);
+        sleep = Tickless_sleepCycles(perTick, perTick, 0xFFFFFFFF);
+        CHECK((uint64_t)sleep + perTick > 0xFFFFFFFFu, "perTick %lu: saturated sleep %lu is short",
+              (unsigned long)perTick, (unsigned long)sleep);
+        checkCompensate(perTick, perTick, 0xFFFFFFFF);
+        checkCompensate(perTick, perTick, sleep);
+    }
+
+    checkSleep(0xFFFFFFFF, 1600000, 1);
+    checkSleep(0xFFFFFFFF, 1600000, 2);
+    checkCompensate(0xFFFFFFFF, 1600000, 0xFFFFFFFE);
+    checkCompensate(0xFFFFFFFF, 1600000, 0xFFFFFFFF);
+    CHECK(Tickless_sleepCycles(1234, 1600000, 0) == 0, "idleTicks 0 must not sleep");
+
+    for (i = 0 ; i < RANDOM_ROUNDS ; i++)
+    {
+        perTick = 1 + randomNext() % SYSTICK_MAX_CYCLES;
+        current = 1 + randomNext() % perTick;               /* SysTick current value, never above a tick */
+        ticks = (i & 1) ? randomNext() : randomNext() % 64;
+
+        checkSleep(current, perTick, ticks);
+        checkCompensate(current, perTick, randomNext());
+        checkCompensate(current, perTick, Tickless_sleepCycles(current, perTick, ticks) - (randomNext() % 3));
+    }
+
+    return testResult("tickless_test");
+}
@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+"""
+[File Name]:     jarvis_config.py
+
+[Description]:   Jarvis-OS offline configuration generator. Turns a JSON system
+                 description (threads, queues, semaphores, timers) into
+                 jarvis_system.h / jarvis_system.c:
+                 - const SysConfig tables (sysconfig.h), kept in flash
+                 - statically sized stacks, queue storage and kernel objects
+                 - #error checks against JarvisOS_CONFIG.h, so a description
+                   that doesn't fit the kernel configuration fails the build
+                 The application calls SysConfig_Init(&g_System) and then
+                 JARVIS_initKernel(). See tools/system_example.json.
+
+                     python3 jarvis_config.py system.json -o app/
+
+[Engineer]:      Hesham Khaled
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+STACK_MIN_SIZE = 32                 # JarvisOS_kernel.h
+IDENTIFIER = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+TIMER_MODES = {"one_shot": "TIMER_ONE_SHOT", "auto_reload": "TIMER_AUTO_RELOAD"}
+
+
+class ConfigError(Exception):
+    pass
+
+
+def read_kernel_config(path):
+    """Numeric #defines of JarvisOS_CONFIG.h, to check the description early."""
+    values = {}
+    if path is None or not os.path.exists(path):
+        return values
+    with open(path) as header:
+        for line in header:
+            match = re.match(r"\s*#define\s+(\w+)\s+\(?\s*(\d+)\s*\)?\s*(/\*.*)?$", line)
+            if match:
+                values[match.group(1)] = int(match.group(2))
+    return values
+
+
+def check(system, kernel):
+    """Validates the description, returns the normalized object lists."""
+    names = set()
+
+    def identifier(kind, entry, key="name"):
+        value = entry.get(key)
+        if not isinstance(value, str) or not IDENTIFIER.match(value):
+            raise ConfigError("%s %r: '%s' must be a C identifier" % (kind, value, key))
+        return value
+
+    def unique(kind, name):
+        if name in names:
+            raise ConfigError("%s '%s': name already used" % (kind, name))
+        names.add(name)
+
+    def positive(kind, name, entry, key, default=None):
+        value = entry.get(key, default)
+        if not isinstance(value, int) or value <= 0:
+            raise ConfigError("%s '%s': '%s' must be a positive integer" % (kind, name, key))
+        return value
+
+    threads = []
+    for entry in system.get("threads", []):
+        name = identifier("thread", entry)
+        unique("thread", name)
+        thread = {
+            "name": name,
+            "entry": identifier("thread", entry, "entry"),
+            "priority": entry.get("priority", 1),
+            "stack": positive("thread", name, entry, "stack", kernel.get("STACK_SIZE", 100)),
+        }
+        if not isinstance(thread["priority"], int) or thread["priority"] < 1:
+            raise ConfigError("thread '%s': priority must be 1 or more, 0 is stateIdle's" % name)
+        if "MAX_PRIORITIES" in kernel and thread["priority"] >= kernel["MAX_PRIORITIES"]:
+            raise ConfigError("thread '%s': priority %d >= MAX_PRIORITIES (%d)"
+                              % (name, thread["priority"], kernel["MAX_PRIORITIES"]))
+        if thread["stack"] < STACK_MIN_SIZE:
+            raise ConfigError("thread '%s': stack of %d words < STACK_MIN_SIZE (%d)"
+                              % (name, thread["stack"], STACK_MIN_SIZE))
+        if "THREAD_ID_MAX_LENGTH" in kernel and len(name) >= kernel["THREAD_ID_MAX_LENGTH"]:
+            raise ConfigError("thread '%s': name doesn't fit THREAD_ID_MAX_LENGTH (%d)"
+                              % (name, kernel["THREAD_ID_MAX_LENGTH"]))
+        threads.append(thread)
+
+    queues = []
+    for entry in system.get("queues", []):
+        name = identifier("queue", entry)
+        unique("queue", name)
+        queue = {"name": name,
+                 "length": positive("queue", name, entry, "length"),
+                 "size": positive("queue", name, entry, "size", 4)}
+        if queue["size"] > 4:
+            raise ConfigError("queue '%s': item size above 4 bytes, items are uint32_t words" % name)
+        queues.append(queue)
+
+    semaphores = []
+    for entry in system.get("semaphores", []):
+        name = identifier("semaphore", entry)
+        unique("semaphore", name)
+        binary = bool(entry.get("binary", False))
+        tokens = entry.get("tokens", 1 if binary else 0)
+        if not isinstance(tokens, int) or tokens < 0 or (binary and tokens > 1):
+            raise ConfigError("semaphore '%s': invalid initial tokens" % name)
+        semaphores.append({"name": name, "binary": binary, "tokens": tokens})
+
+    timers = []
+    for entry in system.get("timers", []):
+        name = identifier("timer", entry)
+        unique("timer", name)
+        mode = entry.get("mode", "one_shot")
+        if mode not in TIMER_MODES:
+            raise ConfigError("timer '%s': mode must be one of %s" % (name, ", ".join(TIMER_MODES)))
+        timers.append({"name": name,
+                       "period": positive("timer", name, entry, "period"),
+                       "mode": TIMER_MODES[mode],
+                       "callback": identifier("timer", entry, "callback"),
+                       "start": bool(entry.get("start", False))})
+
+    used = len(threads) + (1 if timers else 0)      # The timer daemon takes a TCB too
+    if "NUM_OF_THREADS" in kernel and used > kernel["NUM_OF_THREADS"]:
+        raise ConfigError("%d threads%s exceed NUM_OF_THREADS (%d)"
+                          % (used, " (timer daemon included)" if timers else "", kernel["NUM_OF_THREADS"]))
+
+    return threads, queues, semaphores, timers
+
+
+def generate(source, threads, queues, semaphores, timers):
+    """Returns the header and source file contents."""
+    banner = ("/* Generated by tools/jarvis_config.py from %s, do not edit.\n"
+              " * Regenerate it after changing the system description. */\n" % os.path.basename(source))
+
+    h = [banner, "#ifndef _JARVIS_SYSTEM_H", "#define _JARVIS_SYSTEM_H", "",
+         '#include "sysconfig.h"', "", "/* Handles, valid once SysConfig_Init has returned */"]
+    h += ["extern ThreadHandle_t %s;" % t["name"] for t in threads]
+    h += ["extern QueueHandle_t %s;" % q["name"] for q in queues]
+    h += ["extern SemaphoreHandle_t %s;" % s["name"] for s in semaphores]
+    h += ["", "/* Supplied by the application */"]
+    h += ["void %s (void);" % e for e in sorted({t["entry"] for t in threads})]
+    if timers:
+        # TimerHandle_t only exists with SOFTWARE_TIMERS set, the source's #error tells the user so
+        h += ["", "#if (SOFTWARE_TIMERS == 1)"]
+        h += ["extern TimerHandle_t %s;" % t["name"] for t in timers]
+        h += ["void %s (TimerHandle_t *timer);" % c for c in sorted({t["callback"] for t in timers})]
+        h += ["#endif"]
+    h += ["", "extern const SysConfig_System g_System;", "", "#endif", ""]
+
+    c = [banner, '#include "jarvis_system.h"', "", "",
+         "/* Build time checks against JarvisOS_CONFIG.h */"]
+    used = len(threads) + (1 if timers else 0)
+    c += ["#if (%d > NUM_OF_THREADS)" % used,
+          '#error "%s: %d threads%s exceed NUM_OF_THREADS"'
+          % (os.path.basename(source), used, " (timer daemon included)" if timers else ""), "#endif"]
+    if threads:
+        c += ["#if (%d >= MAX_PRIORITIES)" % max(t["priority"] for t in threads),
+              '#error "%s: a thread priority exceeds MAX_PRIORITIES"' % os.path.basename(source), "#endif"]
+        c += ["#if (%d >= THREAD_ID_MAX_LENGTH)" % max(len(t["name"]) for t in threads),
+              '#error "%s: a thread name doesn\'t fit THREAD_ID_MAX_LENGTH"' % os.path.basename(source), "#endif"]
+    if timers:
+        c += ["#if (SOFTWARE_TIMERS != 1)",
+              '#error "%s: timers need SOFTWARE_TIMERS set to 1"' % os.path.basename(source), "#endif"]
+    c.append("")
+
+    c += ["", "/* Handles */"]
+    c += ["ThreadHandle_t %s;" % t["name"] for t in threads]
+    c += ["QueueHandle_t %s;" % q["name"] for q in queues]
+    c += ["SemaphoreHandle_t %s;" % s["name"] for s in semaphores]
+    if timers:
+        c += ["#if (SOFTWARE_TIMERS == 1)"] + ["TimerHandle_t %s;" % t["name"] for t in timers] + ["#endif"]
+
+    c += ["", "/* Statically sized storage */"]
+    c += ["static int32_t %s_Stack[%d];" % (t["name"], t["stack"]) for t in threads]
+    for q in queues:
+        c += ["static xQUEUE %s_Queue;" % q["name"],
+              "static uint32_t %s_Storage[QUEUE_STORAGE_WORDS(%d, %d)];" % (q["name"], q["length"], q["size"])]
+
+    if threads:
+        c += ["", "static const SysConfig_Thread g_SystemThreads[] = {"]
+        c += ['    {(const uint8_t *)"%s", %s, %d, %s_Stack, %d, &%s},'
+              % (t["name"], t["entry"], t["priority"], t["name"], t["stack"], t["name"]) for t in threads]
+        c.append("};")
+    if queues:
+        c += ["", "static const SysConfig_Queue g_SystemQueues[] = {"]
+        c += ["    {%d, %d, &%s_Queue, %s_Storage, &%s}," % (q["length"], q["size"], q["name"], q["name"], q["name"])
+              for q in queues]
+        c.append("};")
+    if semaphores:
+        c += ["", "static const SysConfig_Semaphore g_SystemSemaphores[] = {"]
+        c += ["    {&%s, %d, %d}," % (s["name"], s["tokens"], 1 if s["binary"] else 0) for s in semaphores]
+        c.append("};")
+    if timers:
+        c += ["", "#if (SOFTWARE_TIMERS == 1)", "static const SysConfig_Timer g_SystemTimers[] = {"]
+        c += ["    {&%s, %d, %s, %s, %d}," % (t["name"], t["period"], t["mode"], t["callback"], 1 if t["start"] else 0)
+              for t in timers]
+        c += ["};", "#endif"]
+
+    def table(name, items):
+        return ("    %s, %d," % (name, len(items))) if items else "    NULL, 0,"
+
+    c += ["", "const SysConfig_System g_System = {",
+          table("g_SystemThreads", threads),
+          table("g_SystemQueues", queues),
+          table("g_SystemSemaphores", semaphores),
+          "#if (SOFTWARE_TIMERS == 1)",
+          table("g_SystemTimers", timers),
+          "#endif",
+          "};", ""]
+
+    return "\n".join(h), "\n".join(c)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Generate Jarvis-OS const system tables from a JSON description")
+    parser.add_argument("description", help="JSON system description")
+    parser.add_argument("-o", "--output", default=".", help="directory receiving jarvis_system.h/.c")
+    parser.add_argument("-c", "--config", default=os.path.join(here, "..", "inc", "JarvisOS_CONFIG.h"),
+                        help="JarvisOS_CONFIG.h to check the description against")
+    options = parser.parse_args()
+
+    try:
+        with open(options.description) as source:
+            system = json.load(source)
+        threads, queues, semaphores, timers = check(system, read_kernel_config(options.config))
+    except (OSError, ValueError, ConfigError) as error:
+        sys.exit("jarvis_config: %s" % error)
+
+    header, code = generate(options.description, threads, queues, semaphores, timers)
+
+    with open(os.path.join(options.output, "jarvis_system.h"), "w") as target:
+        target.write(header)
+    with open(os.path.join(options.output, "jarvis_system.c"), "w") as target:
+        target.write(code)
+
+    print("%d threads, %d queues, %d semaphores, %d timers"
+          % (len(threads), len(queues), len(semaphores), len(timers)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
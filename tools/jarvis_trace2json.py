@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""
+[File Name]:     jarvis_trace2json.py
+
+[Description]:   Decodes a raw dump of the Jarvis-OS g_Trace buffer (trace.h)
+                 into Chrome trace_event JSON, viewable in Perfetto
+                 (ui.perfetto.dev) or chrome://tracing.
+                 - Every thread gets a track with one slice per time it ran.
+                 - Kernel calls are instant events on the caller's track.
+                 - Interrupts get their own track.
+
+                 Dump the buffer with the debugger, e.g. in gdb:
+                     dump binary value trace.bin g_Trace
+                 then run:
+                     python3 jarvis_trace2json.py trace.bin -o trace.json
+
+[Engineer]:      Hesham Khaled
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x4352544A
+HEADER = struct.Struct("<IHHIIIHH")
+RECORD = struct.Struct("<IBBHI")
+
+# Trace_Event @ trace.h
+EVENTS = {
+    1: "switch",
+    2: "create",
+    3: "terminate",
+    4: "suspend",
+    5: "block",
+    6: "resume",
+    7: "sem_pend",
+    8: "sem_post",
+    9: "queue_send",
+    10: "queue_receive",
+    11: "isr_enter",
+    12: "isr_exit",
+}
+
+PID = 1
+ISR_TID = 1000                      # Interrupts track, above every TCB slot
+
+
+def parse(dump):
+    """Returns the header fields, the thread names, the records oldest first and
+    how many were dropped. A record whose sequence isn't its position plus one
+    was claimed but not filled when the target was halted."""
+    if len(dump) < HEADER.size:
+        raise ValueError("dump is shorter than the trace header")
+
+    magic, version, record_size, clock_hz, length, head, threads, name_length = HEADER.unpack_from(dump)
+    if magic != TRACE_MAGIC:
+        raise ValueError("bad magic 0x%08X, not a g_Trace dump" % magic)
+    if version != 2 or record_size != RECORD.size:
+        raise ValueError("unsupported trace version %d / record size %d" % (version, record_size))
+
+    names = []
+    offset = HEADER.size
+    for slot in range(threads):
+        raw = dump[offset + slot * name_length: offset + (slot + 1) * name_length]
+        names.append(raw.split(b"\0", 1)[0].decode("ascii", "replace"))
+
+    offset = (offset + threads * name_length + 3) & ~3    # Records are word aligned
+    if len(dump) < offset + length * record_size:
+        raise ValueError("dump is shorter than the %d record ring" % length)
+
+    count = min(head, length)
+    records = []
+    dropped = 0
+    for position in range(head - count, head):
+        timestamp, event, thread, arg, sequence = RECORD.unpack_from(dump, offset + (position % length) * record_size)
+        if sequence != (position + 1) & 0xFFFFFFFF:
+            dropped += 1
+            continue
+        records.append((timestamp, event, thread, arg))
+
+    return clock_hz, names, records, dropped
+
+
+def unwrap(records):
+    """Extends the 32-bit timestamps to a monotonic time base. Writers may land
+    slightly out of order (an ISR between a timestamp and its claim), so small
+    backwards steps are kept as such rather than taken for a wrap."""
+    result = []
+    last = None
+    base = 0
+    for timestamp, event, thread, arg in records:
+        if last is not None:
+            delta = (timestamp - last) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            base += delta
+        else:
+            base = timestamp
+        last = timestamp
+        result.append((base, event, thread, arg))
+
+    result.sort(key=lambda record: record[0])
+    return result
+
+
+def convert(clock_hz, names, records):
+    """Builds the trace_event list."""
+    def name_of(slot):
+        if slot < len(names) and names[slot]:
+            return names[slot]
+        return "slot %d" % slot
+
+    def us(time):
+        return (time - origin) * 1e6 / clock_hz
+
+    trace = [{"ph": "M", "pid": PID, "name": "process_name", "args": {"name": "Jarvis-OS"}},
+             {"ph": "M", "pid": PID, "tid": ISR_TID, "name": "thread_name", "args": {"name": "Interrupts"}}]
+
+    records = unwrap(records)
+    if not records:
+        return trace
+
+    origin = records[0][0]
+    seen = set()
+    running = None                  # (slot, start time) of the thread on the processor
+
+    for time, event, thread, arg in records:
+        name = EVENTS.get(event, "event_%d" % event)
+
+        if thread != 0xFF and thread not in seen:
+            seen.add(thread)
+            trace.append({"ph": "M", "pid": PID, "tid": thread, "name": "thread_name",
+                          "args": {"name": name_of(thread)}})
+
+        if name == "switch":
+            if running is not None:
+                trace.append({"ph": "X", "pid": PID, "tid": running[0], "name": "running",
+                              "ts": us(running[1]), "dur": us(time) - us(running[1])})
+            running = (thread, time)
+
+        elif name in ("isr_enter", "isr_exit"):
+            trace.append({"ph": "B" if name == "isr_enter" else "E", "pid": PID, "tid": ISR_TID,
+                          "name": "exception %d" % arg, "ts": us(time)})
+
+        else:
+            args = {"arg": arg}
+            if name in ("block", "resume"):
+                args = {"by": name_of(arg)}
+            elif name == "create":
+                args = {"priority": arg}
+            elif name == "suspend":
+                args = {"ticks": arg}
+            elif name.startswith(("sem", "queue")):
+                args = {"object": "0x%04X" % arg}
+            trace.append({"ph": "i", "s": "t", "pid": PID, "tid": thread, "name": name,
+                          "ts": us(time), "args": args})
+
+    if running is not None:         # Close the last slice at the end of the trace
+        trace.append({"ph": "X", "pid": PID, "tid": running[0], "name": "running",
+                      "ts": us(running[1]), "dur": us(records[-1][0]) - us(running[1])})
+
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a Jarvis-OS g_Trace dump to Chrome trace_event JSON")
+    parser.add_argument("dump", help="raw binary dump of g_Trace")
+    parser.add_argument("-o", "--output", help="JSON file, stdout if omitted")
+    options = parser.parse_args()
+
+    with open(options.dump, "rb") as source:
+        dump = source.read()
+
+    try:
+        clock_hz, names, records, dropped = parse(dump)
+    except ValueError as error:
+        sys.exit("jarvis_trace2json: %s" % error)
+
+    document = {"traceEvents": convert(clock_hz, names, records), "displayTimeUnit": "ns"}
+
+    if options.output:
+        with open(options.output, "w") as target:
+            json.dump(document, target)
+    else:
+        json.dump(document, sys.stdout)
+
+    print("%d records, %d threads, %d unfinished dropped" % (len(records), len(names), dropped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()